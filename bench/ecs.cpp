@@ -0,0 +1,424 @@
+// measures what `registry_t` costs over raw entt: spawning entities,
+// iterating views, `get_single`/`try_get_single` and `get_resource`, from 1k
+// entities up to the most a registry can hold. only the ecs is touched, so it
+// runs without a gpu.
+//
+//     bench_ecs [--max <entities>] [--save <baseline.json>]
+//               [--compare <baseline.json>] [--threshold <percent>]
+//
+// --save writes the results as a baseline. --compare checks them against a
+// baseline and exits with 1 if any metric got slower by more than the
+// threshold, 10% by default. baselines are only comparable on the same
+// machine and build type.
+#include <fecs.h>
+
+#include <mapped_file/mapped_file.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct position_t {
+    float x;
+    float y;
+};
+
+struct velocity_t {
+    float x;
+    float y;
+};
+
+// the single entity that `get_single` looks for.
+struct player_t {
+    float health;
+};
+
+struct settings_t {
+    float gravity;
+};
+
+static constexpr int32_t ITERATIONS = 9;
+static constexpr size_t MIN_SAMPLE_OPERATIONS = 1'000'000;
+
+// calls per sample of the lookups, their cost doesn't depend on the entity
+// count.
+static constexpr size_t LOOKUP_CALLS = 1'000'000;
+
+static constexpr double DEFAULT_THRESHOLD = 10.0;
+
+// `entt::entity` keeps 20 bits for the entity, a registry can't hold 10M.
+static constexpr size_t MAX_ENTITIES
+    = entt::entt_traits<entt::entity>::entity_mask;
+
+static volatile float s_sink;
+
+// median time of `func` in nanoseconds per operation. small entity counts
+// run `func` several times per sample, so every sample covers at least
+// `MIN_SAMPLE_OPERATIONS` and the clock's resolution doesn't matter. `setup`
+// runs untimed before every call.
+template<typename Setup, typename Func>
+static double measure(size_t operations, Setup setup, Func func)
+{
+    using clock = std::chrono::steady_clock;
+
+    auto repeats = std::max<size_t>(1, MIN_SAMPLE_OPERATIONS / operations);
+
+    std::vector<double> samples;
+    for (int32_t i = 0; i < ITERATIONS; i++) {
+        clock::duration elapsed {};
+
+        for (size_t j = 0; j < repeats; j++) {
+            setup();
+
+            auto start = clock::now();
+            func();
+            elapsed += clock::now() - start;
+        }
+
+        samples.push_back(
+            std::chrono::duration<double, std::nano>(elapsed).count()
+            / (operations * repeats));
+    }
+
+    std::ranges::sort(samples);
+    return samples[samples.size() / 2];
+}
+
+template<typename Func>
+static double measure(size_t operations, Func func)
+{
+    return measure(operations, [] { }, func);
+}
+
+static void populate(entt::registry* rg, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        auto entity = rg->create();
+        rg->emplace<position_t>(entity, static_cast<float>(i), 0.0f);
+        rg->emplace<velocity_t>(entity, 1.0f, 1.0f);
+    }
+
+    rg->emplace<player_t>(rg->create(), 100.0f);
+    rg->ctx().emplace<settings_t>(9.81f);
+}
+
+// `registry_t` and raw entt timings of one operation at one entity count.
+struct result_t {
+    std::string operation;
+    size_t count;
+    double fecs;
+    double entt;
+};
+
+static std::vector<result_t> run(size_t count)
+{
+    std::vector<result_t> results;
+    std::optional<entt::registry> spawned;
+
+    results.push_back({
+        .operation = "spawn_entity",
+        .count = count,
+        .fecs = measure(
+            count,
+            [&spawned] { spawned.emplace(); },
+            [&spawned, count] {
+                registry_t rg(&*spawned);
+                for (size_t i = 0; i < count; i++) {
+                    rg.spawn_entity(position_t { 0.0f, 0.0f },
+                                    velocity_t { 1.0f, 1.0f });
+                }
+            }),
+        .entt = measure(
+            count,
+            [&spawned] { spawned.emplace(); },
+            [&spawned, count] {
+                for (size_t i = 0; i < count; i++) {
+                    auto entity = spawned->create();
+                    spawned->emplace<position_t>(entity, 0.0f, 0.0f);
+                    spawned->emplace<velocity_t>(entity, 1.0f, 1.0f);
+                }
+            }),
+    });
+
+    spawned.reset();
+
+    entt::registry native;
+    populate(&native, count);
+    registry_t rg(&native);
+
+    auto step = [](position_t& position, const velocity_t& velocity) {
+        position.x += velocity.x;
+        position.y += velocity.y;
+    };
+
+    results.push_back({
+        .operation = "get_view",
+        .count = count,
+        .fecs = measure(count,
+                        [&rg, &step] {
+                            rg.get_view<position_t, const velocity_t>().each(
+                                step);
+                        }),
+        .entt = measure(count,
+                        [&native, &step] {
+                            native.view<position_t, const velocity_t>().each(
+                                step);
+                        }),
+    });
+
+    auto player = native.view<player_t>().front();
+
+    results.push_back({
+        .operation = "get_single",
+        .count = count,
+        .fecs = measure(LOOKUP_CALLS,
+                        [&rg] {
+                            float sum = 0.0f;
+                            for (size_t i = 0; i < LOOKUP_CALLS; i++)
+                                sum += rg.get_single<player_t>().health;
+                            s_sink = sum;
+                        }),
+        .entt = measure(LOOKUP_CALLS,
+                        [&native, player] {
+                            float sum = 0.0f;
+                            for (size_t i = 0; i < LOOKUP_CALLS; i++)
+                                sum += native.get<player_t>(player).health;
+                            s_sink = sum;
+                        }),
+    });
+
+    results.push_back({
+        .operation = "try_get_single",
+        .count = count,
+        .fecs = measure(LOOKUP_CALLS,
+                        [&rg] {
+                            float sum = 0.0f;
+                            for (size_t i = 0; i < LOOKUP_CALLS; i++)
+                                sum += rg.try_get_single<player_t>()->health;
+                            s_sink = sum;
+                        }),
+        .entt = measure(LOOKUP_CALLS,
+                        [&native, player] {
+                            float sum = 0.0f;
+                            for (size_t i = 0; i < LOOKUP_CALLS; i++)
+                                sum += native.try_get<player_t>(player)->health;
+                            s_sink = sum;
+                        }),
+    });
+
+    results.push_back({
+        .operation = "get_resource",
+        .count = count,
+        .fecs = measure(LOOKUP_CALLS,
+                        [&rg] {
+                            float sum = 0.0f;
+                            for (size_t i = 0; i < LOOKUP_CALLS; i++)
+                                sum += rg.get_resource<settings_t>().gravity;
+                            s_sink = sum;
+                        }),
+        .entt = measure(LOOKUP_CALLS,
+                        [&native] {
+                            float sum = 0.0f;
+                            for (size_t i = 0; i < LOOKUP_CALLS; i++)
+                                sum += native.ctx().get<settings_t>().gravity;
+                            s_sink = sum;
+                        }),
+    });
+
+    return results;
+}
+
+// metrics are named `<operation>/<fecs|entt>/<entities>`.
+static std::map<std::string, double>
+get_metrics(const std::vector<result_t>& results)
+{
+    std::map<std::string, double> metrics;
+    for (const auto& result : results) {
+        metrics[std::format("{}/fecs/{}", result.operation, result.count)]
+            = result.fecs;
+        metrics[std::format("{}/entt/{}", result.operation, result.count)]
+            = result.entt;
+    }
+
+    return metrics;
+}
+
+static bool save_baseline(const fs::path& path,
+                          const std::map<std::string, double>& metrics)
+{
+    std::ofstream stream(path, std::ios::trunc);
+
+    std::println(stream, "{{");
+    std::println(stream, "  \"unit\": \"ns/op\",");
+    std::println(stream, "  \"metrics\": {{");
+
+    size_t i = 0;
+    for (const auto& [name, value] : metrics) {
+        std::println(stream,
+                     "    \"{}\": {:.4f}{}",
+                     name,
+                     value,
+                     ++i < metrics.size() ? "," : "");
+    }
+
+    std::println(stream, "  }}");
+    std::println(stream, "}}");
+
+    return stream.good();
+}
+
+// reads every `"name": number` pair, which is all a saved baseline holds.
+static std::optional<std::map<std::string, double>>
+load_baseline(const fs::path& path)
+{
+    mapped_file_t file;
+    if (!file.open(path))
+        return {};
+
+    auto bytes = file.get_data();
+    std::string_view text(reinterpret_cast<const char*>(bytes.data()),
+                          bytes.size());
+
+    std::map<std::string, double> metrics;
+
+    size_t position = 0;
+    while ((position = text.find('"', position)) != text.npos) {
+        auto end = text.find('"', position + 1);
+        if (end == text.npos)
+            break;
+
+        auto name = text.substr(position + 1, end - position - 1);
+        position = end + 1;
+
+        auto value = text.find_first_not_of(" \t\r\n", position);
+        if (value == text.npos || text[value] != ':')
+            continue;
+
+        value = text.find_first_not_of(" \t\r\n", value + 1);
+        if (value == text.npos)
+            break;
+
+        double number;
+        auto [next, error] = std::from_chars(
+            text.data() + value, text.data() + text.size(), number);
+
+        if (error == std::errc()) {
+            metrics[std::string(name)] = number;
+            position = next - text.data();
+        }
+    }
+
+    return metrics;
+}
+
+// prints every metric of the baseline that was measured again, returns
+// false if one of them regressed past `threshold` percent.
+static bool compare(const std::map<std::string, double>& baseline,
+                    const std::map<std::string, double>& metrics,
+                    double threshold)
+{
+    std::println("{:<32} {:>12} {:>12} {:>9}",
+                 "metric",
+                 "baseline",
+                 "current",
+                 "change");
+
+    bool passed = true;
+
+    for (const auto& [name, value] : baseline) {
+        auto it = metrics.find(name);
+        if (it == metrics.end() || value <= 0.0)
+            continue;
+
+        auto change = (it->second / value - 1.0) * 100.0;
+        bool regressed = change > threshold;
+        passed = passed && !regressed;
+
+        std::println("{:<32} {:>12.3f} {:>12.3f} {:>8.1f}%{}",
+                     name,
+                     value,
+                     it->second,
+                     change,
+                     regressed ? "  REGRESSED" : "");
+    }
+
+    return passed;
+}
+
+int32_t main(int32_t argc, char** argv)
+{
+    size_t max_count = MAX_ENTITIES;
+    fs::path save_path;
+    fs::path compare_path;
+    double threshold = DEFAULT_THRESHOLD;
+
+    for (int32_t i = 1; i + 1 < argc; i++) {
+        std::string_view arg = argv[i];
+        std::string_view value = argv[++i];
+        auto end = value.data() + value.size();
+
+        if (arg == "--max") {
+            std::from_chars(value.data(), end, max_count);
+        } else if (arg == "--save") {
+            save_path = value;
+        } else if (arg == "--compare") {
+            compare_path = value;
+        } else if (arg == "--threshold") {
+            std::from_chars(value.data(), end, threshold);
+        }
+    }
+
+    // one more entity holds `player_t`.
+    max_count = std::min(max_count, MAX_ENTITIES - 1);
+
+    std::println("{:>16} {:>10} {:>12} {:>12} {:>9}",
+                 "operation",
+                 "entities",
+                 "fecs (ns)",
+                 "entt (ns)",
+                 "overhead");
+
+    std::vector<result_t> results;
+
+    for (size_t count = 1'000; count <= max_count; count *= 10) {
+        for (auto& result : run(count)) {
+            std::println("{:>16} {:>10} {:>12.3f} {:>12.3f} {:>8.1f}%",
+                         result.operation,
+                         result.count,
+                         result.fecs,
+                         result.entt,
+                         (result.fecs / result.entt - 1.0) * 100.0);
+
+            results.push_back(std::move(result));
+        }
+    }
+
+    auto metrics = get_metrics(results);
+
+    if (!save_path.empty() && !save_baseline(save_path, metrics)) {
+        std::println(
+            stderr, "ERROR: can't write baseline '{}'", save_path.string());
+        return 1;
+    }
+
+    if (compare_path.empty())
+        return 0;
+
+    auto baseline = load_baseline(compare_path);
+    if (!baseline) {
+        std::println(
+            stderr, "ERROR: can't read baseline '{}'", compare_path.string());
+        return 1;
+    }
+
+    std::println("");
+    return compare(*baseline, metrics, threshold) ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+// compares iterating the sandbox workload (`quad_2d_t` + `velocity_t`)
+// through a view, through an owning group and through the contiguous chunks of
+// an owning group. half of the quads are static and have no velocity, which
+// is what makes the view pay for sparse lookups.
+#include <fecs.h>
+#include <renderer_2d.h>
+
+#include <algorithm>
+#include <chrono>
+#include <print>
+#include <random>
+#include <vector>
+
+struct velocity_t {
+    float x;
+    float y;
+};
+
+static constexpr float WINDOW_WIDTH = 1280.0f;
+static constexpr float WINDOW_HEIGHT = 720.0f;
+static constexpr float DELTA_TIME = 1.0f / 60.0f;
+static constexpr int32_t ITERATIONS = 50;
+
+static void bounce(quad_2d_t& quad, velocity_t& velocity)
+{
+    quad.position.x += velocity.x * DELTA_TIME;
+    quad.position.y += velocity.y * DELTA_TIME;
+
+    if (quad.position.x + quad.dimension.x >= WINDOW_WIDTH) {
+        quad.position.x = WINDOW_WIDTH - quad.dimension.x;
+        velocity.x *= -1;
+    } else if (quad.position.x <= 0.0f) {
+        quad.position.x = 0.0f;
+        velocity.x *= -1;
+    }
+
+    if (quad.position.y + quad.dimension.y >= WINDOW_HEIGHT) {
+        quad.position.y = WINDOW_HEIGHT - quad.dimension.y;
+        velocity.y *= -1;
+    } else if (quad.position.y <= 0.0f) {
+        quad.position.y = 0.0f;
+        velocity.y *= -1;
+    }
+}
+
+static void populate(entt::registry* rg, size_t count)
+{
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<float> x_dist(0.0f, WINDOW_WIDTH);
+    std::uniform_real_distribution<float> y_dist(0.0f, WINDOW_HEIGHT);
+    std::uniform_real_distribution<float> v_dist(-100.0f, 100.0f);
+
+    registry_t registry(rg);
+    for (size_t i = 0; i < count; i++) {
+        auto quad = make_quad(glm::vec2(x_dist(gen), y_dist(gen)),
+                              glm::vec2(20.0f));
+
+        if (i % 2 == 0)
+            registry.spawn_entity(quad,
+                                  velocity_t { v_dist(gen), v_dist(gen) });
+        else
+            registry.spawn_entity(quad);
+    }
+}
+
+// median time of one iteration in milliseconds.
+template<typename Func>
+static double measure(Func func)
+{
+    using clock = std::chrono::steady_clock;
+
+    std::vector<double> samples;
+    for (int32_t i = 0; i < ITERATIONS; i++) {
+        auto start = clock::now();
+        func();
+        auto end = clock::now();
+
+        samples.push_back(
+            std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    std::ranges::sort(samples);
+    return samples[samples.size() / 2];
+}
+
+int32_t main()
+{
+    std::println("{:>10} {:>12} {:>12} {:>12}",
+                 "entities",
+                 "view (ms)",
+                 "group (ms)",
+                 "chunks (ms)");
+
+    for (size_t count : { 10'000, 100'000, 1'000'000 }) {
+        entt::registry view_rg;
+        populate(&view_rg, count);
+
+        auto view = view_rg.view<quad_2d_t, velocity_t>();
+        auto view_ms = measure([&view] {
+            for (auto entity : view) {
+                auto [quad, velocity] = view.get(entity);
+                bounce(quad, velocity);
+            }
+        });
+
+        entt::registry group_rg;
+        registry_t(&group_rg).declare_group<quad_2d_t, velocity_t>();
+        populate(&group_rg, count);
+
+        auto group = registry_t(&group_rg).get_group<quad_2d_t, velocity_t>();
+        auto group_ms = measure([&group] {
+            for (auto [entity, quad, velocity] : group.each())
+                bounce(quad, velocity);
+        });
+
+        group_t<quad_2d_t, velocity_t> chunked(group);
+        auto chunks_ms = measure([&chunked] {
+            chunked.each_chunk([](std::span<quad_2d_t> quads,
+                                  std::span<velocity_t> velocities) {
+                for (size_t i = 0; i < quads.size(); i++)
+                    bounce(quads[i], velocities[i]);
+            });
+        });
+
+        std::println("{:>10} {:>12.3f} {:>12.3f} {:>12.3f}",
+                     count,
+                     view_ms,
+                     group_ms,
+                     chunks_ms);
+    }
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+// measures assigning point lights to the clusters of a camera frustum on the
+// cpu, without a window or gl context. lights are scattered around the camera
+// so some are culled and some cover many clusters.
+#include <light_clusters/light_clusters.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <print>
+#include <random>
+#include <vector>
+
+static constexpr float FIELD_OF_VIEW = 45.0f;
+static constexpr float ASPECT_RATIO = 16.0f / 9.0f;
+static constexpr float NEAR_PLANE = 0.1f;
+static constexpr float FAR_PLANE = 100.0f;
+static constexpr int32_t ITERATIONS = 50;
+
+static std::vector<glm::vec4> make_lights(size_t count)
+{
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<float> position_dist(-FAR_PLANE, FAR_PLANE);
+    std::uniform_real_distribution<float> height_dist(0.0f, 10.0f);
+    std::uniform_real_distribution<float> radius_dist(1.0f, 8.0f);
+
+    std::vector<glm::vec4> lights(count);
+    for (auto& light : lights) {
+        light = glm::vec4(position_dist(gen),
+                          height_dist(gen),
+                          position_dist(gen),
+                          radius_dist(gen));
+    }
+
+    return lights;
+}
+
+// median time of one iteration in milliseconds.
+template<typename Func>
+static double measure(Func func)
+{
+    using clock = std::chrono::steady_clock;
+
+    std::vector<double> samples;
+    for (int32_t i = 0; i < ITERATIONS; i++) {
+        auto start = clock::now();
+        func();
+        auto end = clock::now();
+
+        samples.push_back(
+            std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    std::ranges::sort(samples);
+    return samples[samples.size() / 2];
+}
+
+int32_t main()
+{
+    auto projection = glm::perspective(
+        glm::radians(FIELD_OF_VIEW), ASPECT_RATIO, NEAR_PLANE, FAR_PLANE);
+    auto view = glm::lookAt(glm::vec3(0.0f, 2.0f, 0.0f),
+                            glm::vec3(0.0f, 2.0f, -1.0f),
+                            glm::vec3(0.0f, 1.0f, 0.0f));
+
+    light_clusters_t clusters;
+    clusters.set_projection(projection, NEAR_PLANE, FAR_PLANE);
+
+    std::println("{:>10} {:>12} {:>14} {:>16}",
+                 "lights",
+                 "cull (ms)",
+                 "assignments",
+                 "max per cluster");
+
+    for (size_t count : { 256, 1'024, 4'096, 16'384 }) {
+        auto lights = make_lights(count);
+
+        auto cull_ms = measure(
+            [&clusters, &view, &lights] { clusters.cull(view, lights); });
+
+        auto offsets = clusters.get_offsets();
+
+        uint32_t max_lights = 0;
+        for (size_t i = 0; i + 1 < offsets.size(); i++)
+            max_lights = std::max(max_lights, offsets[i + 1] - offsets[i]);
+
+        std::println("{:>10} {:>12.3f} {:>14} {:>16}",
+                     count,
+                     cull_ms,
+                     clusters.get_light_indices().size(),
+                     max_lights);
+    }
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+// compares loading .obj files with tinyobjloader against `parse_obj`, and
+// checks that both produce the same triangles. takes the files to load as
+// arguments, or every model under `resources/models/` when there are none.
+#include <obj_parser/obj_parser.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <print>
+#include <vector>
+
+static constexpr int32_t ITERATIONS = 10;
+
+// median time of one iteration in milliseconds.
+template<typename Func>
+static double measure(Func func)
+{
+    using clock = std::chrono::steady_clock;
+
+    std::vector<double> samples;
+    for (int32_t i = 0; i < ITERATIONS; i++) {
+        auto start = clock::now();
+        func();
+        auto end = clock::now();
+
+        samples.push_back(
+            std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    std::ranges::sort(samples);
+    return samples[samples.size() / 2];
+}
+
+static float max_difference(const std::vector<float>& a,
+                            const std::vector<float>& b)
+{
+    if (a.size() != b.size())
+        return INFINITY;
+
+    float difference = 0.0f;
+    for (size_t i = 0; i < a.size(); i++)
+        difference = std::max(difference, std::fabs(a[i] - b[i]));
+
+    return difference;
+}
+
+// true when both loaders produced the same triangles with the same materials.
+static bool compare(const tinyobj::ObjReader& reader, const obj_data_t& data)
+{
+    size_t triangle = 0;
+
+    for (const auto& shape : reader.GetShapes()) {
+        const auto& mesh = shape.mesh;
+
+        for (size_t f = 0; f < mesh.material_ids.size(); f++, triangle++) {
+            if (triangle >= data.material_ids.size()
+                || mesh.material_ids[f] != data.material_ids[triangle]) {
+                return false;
+            }
+
+            for (size_t v = 0; v < 3; v++) {
+                const auto& expected = mesh.indices[3 * f + v];
+                const auto& index = data.indices[3 * triangle + v];
+
+                if (expected.vertex_index != index.position
+                    || expected.normal_index != index.normal
+                    || expected.texcoord_index != index.texcoord) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return triangle == data.material_ids.size();
+}
+
+int32_t main(int32_t argc, char** argv)
+{
+    std::vector<fs::path> paths(argv + 1, argv + argc);
+
+    if (paths.empty()) {
+        for (const auto& entry :
+             fs::recursive_directory_iterator("resources/models/")) {
+            if (entry.path().extension() == ".obj")
+                paths.push_back(entry.path());
+        }
+    }
+
+    std::println("{:>24} {:>10} {:>14} {:>14} {:>8} {:>12}",
+                 "model",
+                 "triangles",
+                 "tinyobj (ms)",
+                 "parse_obj (ms)",
+                 "match",
+                 "max diff");
+
+    for (const auto& path : paths) {
+        tinyobj::ObjReader reader;
+        auto tinyobj_ms = measure([&reader, &path] {
+            reader = {};
+            reader.ParseFromFile(path.string());
+        });
+
+        std::expected<obj_data_t, std::string> data;
+        auto parse_ms = measure([&data, &path] { data = parse_obj(path); });
+
+        if (!data) {
+            std::println(stderr, "ERROR: {}", data.error());
+            continue;
+        }
+
+        const auto& attrib = reader.GetAttrib();
+        auto difference = std::max({
+            max_difference(attrib.vertices, data->positions),
+            max_difference(attrib.normals, data->normals),
+            max_difference(attrib.texcoords, data->texcoords),
+        });
+
+        std::println("{:>24} {:>10} {:>14.3f} {:>14.3f} {:>8} {:>12g}",
+                     path.filename().string(),
+                     data->material_ids.size(),
+                     tinyobj_ms,
+                     parse_ms,
+                     compare(reader, *data) ? "yes" : "no",
+                     difference);
+    }
+
+    return 0;
+}
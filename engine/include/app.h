@@ -1,8 +1,16 @@
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include <fecs.h>
+#include <frame_timings.h>
+#include <memory_stats.h>
+#include <task.h>
 
 class app_t;
 
@@ -29,6 +37,68 @@ struct app_state_t {
     bool running { false };
 };
 
+// returns the delta time of the next frame, or nothing to stop the main loop.
+using frame_clock_t = std::function<std::optional<float>()>;
+
+// checked right before a system is dispatched, keep it cheap.
+using run_condition_t = std::function<bool(registry_t)>;
+
+// when and how often an update or fixed update system runs.
+struct system_options_t {
+    // set the system belongs to, see `app_t::configure_set`.
+    std::string set;
+
+    // the system is skipped while this returns false. skipped frames don't
+    // add to the `dt` of its next run.
+    run_condition_t run_if;
+
+    // runs every `every_frames`th frame, or `rate_hz` times per second when
+    // that is set. `dt` is the time since the last run. systems sharing a
+    // frame interval are spread over different frames.
+    uint32_t every_frames { 1 };
+    float rate_hz { 0.0f };
+
+    // each run only handles one of `slices` subsets of the entities, see
+    // `system_slice_t`, so every entity is visited once per `slices` runs.
+    uint32_t slices { 1 };
+};
+
+struct system_set_options_t {
+    // sets whose systems run before or after the systems of this set.
+    std::vector<std::string> after;
+    std::vector<std::string> before;
+
+    // checked once per frame, skips every system of the set.
+    run_condition_t run_if;
+};
+
+template<typename T>
+struct scheduled_system_t {
+    static constexpr uint32_t NO_SET = UINT32_MAX;
+
+    T system;
+    std::string name;
+
+    uint32_t memory_scope;
+
+    system_options_t options;
+    uint32_t set { NO_SET };
+
+    // frames and time since the last run, and the slice of the next one.
+    uint32_t frames { 0 };
+    float elapsed { 0.0f };
+    float phase { 0.0f };
+    uint32_t slice { 0 };
+};
+
+struct system_set_t {
+    std::string name;
+    system_set_options_t options;
+
+    // evaluated at the start of every frame.
+    bool active { true };
+};
+
 class app_t {
 public:
     void add_plugin(std::unique_ptr<plugin_t> plugin);
@@ -37,21 +107,48 @@ public:
 
     void add_system(shutdown_system_t system);
 
-    void add_system(update_system_t system);
+    void add_system(update_system_t system, system_options_t options = {});
+
+    void add_system(fixed_update_system_t system,
+                    system_options_t options = {});
+
+    // systems run in the order they were added, except where the sets they
+    // belong to are ordered against each other. can be called before or
+    // after the systems of the set are added.
+    void configure_set(std::string_view name, system_set_options_t options);
 
-    void add_system(fixed_update_system_t system);
+    // replaces the wall clock of the main loop, e.g. to replay a recorded
+    // session with its original frame times.
+    void set_frame_clock(frame_clock_t clock);
 
     void run();
 
     registry_t get_registry();
 
+private:
+    uint32_t get_set(std::string_view name);
+
+    // orders both update stages by their sets, fails on a cycle.
+    std::expected<void, std::string> sort_systems();
+
 private:
     app_state_t m_app_state;
 
+    frame_arena_pool_t m_frame_arenas;
+    command_buffer_pool_t m_commands;
+    memory_stats_t m_memory_stats;
+    frame_timings_t m_timings;
+    task_scheduler_t m_tasks;
+
+    frame_clock_t m_frame_clock;
+
     entt::registry m_rg;
 
-    std::vector<startup_system_t> m_startup_systems;
-    std::vector<shutdown_system_t> m_shutdown_systems;
-    std::vector<update_system_t> m_update_systems;
-    std::vector<fixed_update_system_t> m_fixed_update_systems;
+    std::vector<scheduled_system_t<startup_system_t>> m_startup_systems;
+    std::vector<scheduled_system_t<shutdown_system_t>> m_shutdown_systems;
+    std::vector<scheduled_system_t<update_system_t>> m_update_systems;
+    std::vector<scheduled_system_t<fixed_update_system_t>>
+        m_fixed_update_systems;
+
+    std::vector<system_set_t> m_sets;
 };
\ No newline at end of file
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <app.h>
+#include <fecs.h>
+#include <task.h>
+
+#include <model/model.h>
+#include <shader/shader.h>
+#include <texture/texture.h>
+
+namespace fs = std::filesystem;
+
+// refers to an asset owned by `asset_manager_t`. handles are plain values and
+// can be stored in components, a handle outlives its asset safely because
+// the generation of the slot changes when the asset is unloaded.
+template<typename T>
+struct asset_handle_t {
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    uint32_t index { INVALID_INDEX };
+    uint32_t generation { 0 };
+
+    bool is_valid() const
+    {
+        return index != INVALID_INDEX;
+    }
+
+    bool operator==(const asset_handle_t& other) const = default;
+};
+
+using model_handle_t = asset_handle_t<model_t>;
+using texture_handle_t = asset_handle_t<texture_t>;
+using shader_handle_t = asset_handle_t<shader_t>;
+
+struct asset_budget_t {
+    // unreferenced assets are evicted, least recently used first, while
+    // either budget is exceeded.
+    size_t cpu_bytes { 256 << 20 };
+    size_t gpu_bytes { 512 << 20 };
+
+    // texture mips uploaded per frame.
+    size_t upload_bytes { 4 << 20 };
+};
+
+struct asset_usage_t {
+    size_t cpu_bytes { 0 };
+    size_t gpu_bytes { 0 };
+
+    size_t loaded { 0 };
+    size_t unreferenced { 0 };
+};
+
+// owns every model, texture and shader loaded from disk. loading a path that
+// is already loaded returns the existing asset and adds a reference to it.
+// assets without references stay cached until the memory budget needs their
+// space.
+class asset_manager_t {
+public:
+    asset_manager_t(asset_budget_t budget = {});
+
+    asset_manager_t(const asset_manager_t& other) = delete;
+    asset_manager_t& operator=(const asset_manager_t& other) = delete;
+
+    asset_manager_t(asset_manager_t&& other) = default;
+    asset_manager_t& operator=(asset_manager_t&& other) = default;
+
+    std::expected<model_handle_t, std::string>
+    load_model(const fs::path& path);
+
+    std::expected<texture_handle_t, std::string>
+    load_texture(const fs::path& path);
+
+    std::expected<shader_handle_t, std::string>
+    load_shader(const fs::path& path);
+
+    // returns nullptr if the asset of `handle` has been unloaded. loading more
+    // assets doesn't move it, the pointer stays valid until the asset is
+    // unloaded. an asset without references can be evicted by any `update`,
+    // so `acquire` it before holding the pointer across frames.
+    template<typename T>
+    T* get(asset_handle_t<T> handle)
+    {
+        auto slot = get_pool<T>()->get_slot(handle);
+        if (!slot)
+            return nullptr;
+
+        slot->last_used = m_tick;
+        return &*slot->asset;
+    }
+
+    template<typename T>
+    void acquire(asset_handle_t<T> handle)
+    {
+        if (auto slot = get_pool<T>()->get_slot(handle))
+            slot->ref_count++;
+    }
+
+    // the asset stays cached after its last reference is released.
+    template<typename T>
+    void release(asset_handle_t<T> handle)
+    {
+        auto slot = get_pool<T>()->get_slot(handle);
+        if (slot && slot->ref_count > 0) {
+            slot->ref_count--;
+            slot->last_used = m_tick;
+        }
+    }
+
+    // true once the asset and its textures are fully streamed in. also true
+    // for an unloaded asset, nothing more happens to it, `get` tells the two
+    // apart.
+    bool is_ready(model_handle_t handle);
+
+    bool is_ready(texture_handle_t handle);
+
+    bool is_ready(shader_handle_t handle);
+
+    void set_budget(asset_budget_t budget);
+
+    asset_budget_t get_budget() const;
+
+    asset_usage_t get_usage() const;
+
+    // streams pending texture mips and evicts assets over the budget.
+    void update();
+
+    // unloads unreferenced assets until the usage fits the budget.
+    void evict();
+
+    // unloads every asset, referenced or not.
+    void clear();
+
+private:
+    template<typename T>
+    struct slot_t {
+        std::optional<T> asset;
+        std::string key;
+
+        uint32_t generation { 1 };
+        uint32_t ref_count { 0 };
+
+        size_t cpu_bytes { 0 };
+        size_t gpu_bytes { 0 };
+
+        uint64_t last_used { 0 };
+    };
+
+    // slots live in a deque so growing the pool doesn't move the assets
+    // `get` pointed to.
+    template<typename T>
+    struct pool_t {
+        std::deque<slot_t<T>> slots;
+        std::vector<uint32_t> free_slots;
+
+        std::unordered_map<std::string, uint32_t> lookup;
+
+        slot_t<T>* get_slot(asset_handle_t<T> handle)
+        {
+            if (handle.index >= slots.size())
+                return nullptr;
+
+            auto& slot = slots[handle.index];
+            if (slot.generation != handle.generation || !slot.asset)
+                return nullptr;
+
+            return &slot;
+        }
+    };
+
+    template<typename T>
+    pool_t<T>* get_pool()
+    {
+        if constexpr (std::is_same_v<T, model_t>)
+            return &m_models;
+        else if constexpr (std::is_same_v<T, texture_t>)
+            return &m_textures;
+        else
+            return &m_shaders;
+    }
+
+    template<typename T>
+    std::optional<asset_handle_t<T>> find(const std::string& key);
+
+    template<typename T>
+    asset_handle_t<T> insert(std::string key,
+                             T asset,
+                             size_t cpu_bytes,
+                             size_t gpu_bytes);
+
+    template<typename T>
+    void unload(uint32_t index);
+
+    void destroy(uint32_t index, model_t* model);
+    void destroy(uint32_t index, texture_t* texture);
+    void destroy(uint32_t index, shader_t* shader);
+
+    bool is_over_budget() const;
+
+private:
+    pool_t<model_t> m_models;
+    pool_t<texture_t> m_textures;
+    pool_t<shader_t> m_shaders;
+
+    // textures referenced by the materials of each model slot.
+    std::unordered_map<uint32_t, std::vector<texture_handle_t>>
+        m_model_textures;
+
+    texture_streamer_t m_streamer;
+
+    asset_budget_t m_budget;
+    asset_usage_t m_usage;
+
+    uint64_t m_tick { 1 };
+};
+
+// resumes a task once `is_ready` holds for `handle`, or right away without
+// an `asset_manager_t` resource.
+template<typename T>
+task_wait_t asset_ready(asset_handle_t<T> handle)
+{
+    return wait_until([handle](registry_t rg) {
+        auto assets = rg.try_get_resource<asset_manager_t>();
+        return !assets || assets->is_ready(handle);
+    });
+}
+
+// makes an `asset_manager_t` available as a resource and streams textures
+// every frame. assets are unloaded in a shutdown system, add this plugin
+// before the renderer so it runs while the gl context still exists.
+class asset_plugin_t : public plugin_t {
+public:
+    asset_plugin_t(asset_budget_t budget = {});
+
+    virtual ~asset_plugin_t() override = default;
+
+    virtual PluginResult build(app_t* app) override;
+
+    static SystemResult update(resource_t<asset_manager_t> assets);
+
+    static SystemResult shutdown(resource_t<asset_manager_t> assets);
+
+private:
+    asset_budget_t m_budget;
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <entt/entt.hpp>
+
+#include "frame_arena.h"
+#include "per_thread.h"
+
+// records structural changes to the registry so they can be made later, at a
+// point where no view is being iterated. every thread gets its own buffer
+// through `command_buffer_pool_t`, so recording never needs a lock.
+class command_buffer_t {
+public:
+    command_buffer_t() = default;
+
+    ~command_buffer_t();
+
+    command_buffer_t(const command_buffer_t& other) = delete;
+    command_buffer_t& operator=(const command_buffer_t& other) = delete;
+
+    template<typename... Args>
+    void spawn_entity(Args&&... args)
+    {
+        using payload_t = std::tuple<std::remove_cvref_t<Args>...>;
+
+        push<payload_t>(
+            [](entt::registry* rg, payload_t* payload) {
+                auto entity = rg->create();
+                std::apply(
+                    [rg, entity]<typename... C>(C&... components) {
+                        (rg->emplace<C>(entity, std::move(components)), ...);
+                    },
+                    *payload);
+            },
+            std::forward<Args>(args)...);
+    }
+
+    void destroy_entity(entt::entity entity);
+
+    template<typename T, typename... Args>
+    void emplace(entt::entity entity, Args&&... args)
+    {
+        struct payload_t {
+            entt::entity entity;
+            T component;
+        };
+
+        push<payload_t>(
+            [](entt::registry* rg, payload_t* payload) {
+                if (rg->valid(payload->entity)) {
+                    rg->emplace_or_replace<T>(payload->entity,
+                                              std::move(payload->component));
+                }
+            },
+            entity,
+            T { std::forward<Args>(args)... });
+    }
+
+    template<typename T>
+    void remove(entt::entity entity)
+    {
+        push<entt::entity>(
+            [](entt::registry* rg, entt::entity* entity) {
+                if (rg->valid(*entity))
+                    rg->remove<T>(*entity);
+            },
+            entity);
+    }
+
+    // runs the recorded commands in order and empties the buffer.
+    void apply(entt::registry* rg);
+
+    bool empty() const;
+
+private:
+    struct command_t {
+        void (*apply)(entt::registry* rg, void* payload);
+        void (*destroy)(void* payload);
+        void* payload;
+    };
+
+    template<typename P, typename Apply, typename... Args>
+    void push(Apply, Args&&... args)
+    {
+        static_assert(std::is_empty_v<Apply>, "commands must not capture");
+
+        auto payload = new (m_storage.allocate(sizeof(P), alignof(P)))
+            P { std::forward<Args>(args)... };
+
+        m_commands.push_back({
+            .apply =
+                [](entt::registry* rg, void* payload) {
+                    Apply {}(rg, static_cast<P*>(payload));
+                },
+            .destroy =
+                [](void* payload) { static_cast<P*>(payload)->~P(); },
+            .payload = payload,
+        });
+    }
+
+    void clear();
+
+private:
+    std::vector<command_t> m_commands;
+    frame_arena_t m_storage { 64 * 1024 };
+};
+
+// one command buffer per thread. buffers are applied by the app at its sync
+// points, while no system is running.
+class command_buffer_pool_t {
+public:
+    command_buffer_t* get_buffer();
+
+    void apply(entt::registry* rg);
+
+private:
+    per_thread_t<command_buffer_t> m_buffers;
+};
@@ -1,35 +1,333 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <expected>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <print>
+#include <ranges>
+#include <span>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <entt/entt.hpp>
 
+#include "command_buffer.h"
+#include "frame_arena.h"
+#include "snapshot.h"
+
+// query filters. a view with `added_t<T>` or `changed_t<T>` among its types
+// only yields the entities whose `T` was added, or added or changed, since
+// the system last ran. `T` has to be tracked, see
+// `registry_t::track_changes`.
+template<typename T>
+struct added_t { };
+
+template<typename T>
+struct changed_t { };
+
+// ticks of the last addition and change of a tracked `T`, stored next to it
+// on every entity.
+template<typename T>
+struct change_ticks_t {
+    uint64_t added;
+    uint64_t changed;
+};
+
+// maps a view argument to the type the entt view is built from, filters
+// read the ticks of their component.
+template<typename T>
+struct change_filter_t {
+    using view_type = T;
+
+    static constexpr bool is_filter = false;
+};
+
+template<typename T>
+struct change_filter_t<added_t<T>> {
+    using view_type = const change_ticks_t<T>;
+
+    static constexpr bool is_filter = true;
+
+    static bool test(const change_ticks_t<T>& ticks, uint64_t since)
+    {
+        return ticks.added > since;
+    }
+};
+
+template<typename T>
+struct change_filter_t<changed_t<T>> {
+    using view_type = const change_ticks_t<T>;
+
+    static constexpr bool is_filter = true;
+
+    static bool test(const change_ticks_t<T>& ticks, uint64_t since)
+    {
+        return ticks.changed > since;
+    }
+};
+
+template<typename... T>
+constexpr bool has_change_filter_v = (change_filter_t<T>::is_filter || ...);
+
+// the entt view for a list of components and filters.
+template<typename... T>
+using change_view_t = decltype(std::declval<entt::registry&>()
+                                   .view<typename change_filter_t<T>::
+                                             view_type...>());
+
+// view that skips the entities failing its change filters. it walks every
+// entity of the underlying view but only reads their ticks, the components
+// of the skipped entities are never touched.
+template<typename... T>
+class filtered_view_t {
+public:
+    using view_type = change_view_t<T...>;
+    using base_iterator = decltype(std::declval<const view_type&>().begin());
+
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = entt::entity;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const entt::entity*;
+        using reference = entt::entity;
+
+        iterator() = default;
+
+        iterator(const filtered_view_t* owner,
+                 base_iterator it,
+                 base_iterator end)
+            : m_owner(owner)
+            , m_it(it)
+            , m_end(end)
+        {
+            skip();
+        }
+
+        entt::entity operator*() const
+        {
+            return *m_it;
+        }
+
+        iterator& operator++()
+        {
+            ++m_it;
+            skip();
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            auto previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const iterator& other) const
+        {
+            return m_it == other.m_it;
+        }
+
+    private:
+        void skip()
+        {
+            while (m_it != m_end && !m_owner->passes(*m_it))
+                ++m_it;
+        }
+
+    private:
+        const filtered_view_t* m_owner { nullptr };
+        base_iterator m_it {};
+        base_iterator m_end {};
+    };
+
+    filtered_view_t(const view_type& view, uint64_t since)
+        : m_view(view)
+        , m_since(since)
+    {
+    }
+
+    iterator begin() const
+    {
+        return { this, m_view.begin(), m_view.end() };
+    }
+
+    iterator end() const
+    {
+        return { this, m_view.end(), m_view.end() };
+    }
+
+    bool contains(entt::entity entity) const
+    {
+        return m_view.contains(entity) && passes(entity);
+    }
+
+    template<typename... C>
+    decltype(auto) get(entt::entity entity) const
+    {
+        return m_view.template get<C...>(entity);
+    }
+
+    // picks the smallest storage again to lead the iteration.
+    void refresh()
+    {
+        m_view.refresh();
+    }
+
+    size_t size_hint() const
+    {
+        return m_view.size_hint();
+    }
+
+    uint64_t get_since() const
+    {
+        return m_since;
+    }
+
+private:
+    template<typename F>
+    bool passes_filter(entt::entity entity) const
+    {
+        using filter_t = change_filter_t<F>;
+
+        if constexpr (filter_t::is_filter) {
+            using ticks_t = std::remove_const_t<typename filter_t::view_type>;
+            return filter_t::test(m_view.template get<ticks_t>(entity),
+                                  m_since);
+        } else {
+            return true;
+        }
+    }
+
+    bool passes(entt::entity entity) const
+    {
+        return (passes_filter<T>(entity) && ...);
+    }
+
+private:
+    view_type m_view;
+    uint64_t m_since;
+};
+
 class registry_t {
 public:
-    registry_t(entt::registry* rg)
+    // `last_run` is the change tick the owning system last ran at, the
+    // change filters of `get_view` compare against it.
+    registry_t(entt::registry* rg, uint64_t last_run = 0)
         : m_rg(rg)
+        , m_last_run(last_run)
     {
     }
 
     template<typename... Args>
-    void spawn_entity(Args&&... args)
+    entt::entity spawn_entity(Args&&... args)
     {
         auto entity = m_rg->create();
-        ((m_rg->emplace<Args>(entity, std::forward<Args>(args))), ...);
+        ((m_rg->emplace<std::remove_cvref_t<Args>>(entity,
+                                                   std::forward<Args>(args))),
+         ...);
+
+        return entity;
+    }
+
+    // spawns one entity per element of `entities`, filling each storage in a
+    // single pass. every argument is either a sized range holding one
+    // component per entity or a single component copied to all of them.
+    template<typename... Args>
+    void spawn_entities(std::span<entt::entity> entities, const Args&... args)
+    {
+        m_rg->create(entities.begin(), entities.end());
+        (insert_components(entities, args), ...);
+    }
+
+    // same as above, the returned handles live in the frame arena and are
+    // only valid until the end of the frame.
+    template<typename... Args>
+    std::pmr::vector<entt::entity> spawn_entities(size_t count,
+                                                  const Args&... args)
+    {
+        std::pmr::vector<entt::entity> entities(count, get_frame_arena());
+        spawn_entities(std::span(entities), args...);
+
+        return entities;
     }
 
     template<typename T, typename... Args>
     void put_resource(Args&&... args)
     {
         m_rg->ctx().emplace<T>(std::forward<Args>(args)...);
+        s_resource_epoch.fetch_add(1, std::memory_order_relaxed);
     }
 
+    // `Args` can hold `added_t` and `changed_t` filters.
     template<typename... Args>
     auto get_view()
     {
-        return m_rg->view<Args...>();
+        if constexpr (has_change_filter_v<Args...>) {
+            return filtered_view_t<Args...>(
+                m_rg->view<typename change_filter_t<Args>::view_type...>(),
+                m_last_run);
+        } else {
+            return m_rg->view<Args...>();
+        }
+    }
+
+    // keeps `change_ticks_t<T>` next to every `T` so views can filter on
+    // additions and changes. like other signals, only changes that go
+    // through the registry (`patch`, `replace`, `emplace_or_replace`, the
+    // command buffer, `mark_changed`) are seen, writes through a view are
+    // not. components that already exist count as added now.
+    template<typename T>
+    void track_changes()
+    {
+        m_rg->on_construct<T>().template connect<&on_tracked_added<T>>();
+        m_rg->on_update<T>().template connect<&on_tracked_changed<T>>();
+        m_rg->on_destroy<T>().template connect<&on_tracked_removed<T>>();
+
+        auto& ticks = m_rg->storage<change_ticks_t<T>>();
+        auto tick = get_change_tick();
+
+        for (auto entity : m_rg->view<T>()) {
+            if (!ticks.contains(entity))
+                ticks.emplace(entity, tick, tick);
+        }
+    }
+
+    // flags `T` of `entity` as changed and notifies its `on_update`
+    // listeners, for components written in place.
+    template<typename T>
+    void mark_changed(entt::entity entity)
+    {
+        m_rg->patch<T>(entity);
+    }
+
+    template<typename T, typename... Func>
+    T& patch_component(entt::entity entity, Func&&... func)
+    {
+        return m_rg->patch<T>(entity, std::forward<Func>(func)...);
+    }
+
+    // declares an owning group for components that are usually iterated
+    // together. the owned storages are kept packed in the same order, so the
+    // group can be walked linearly. a component can be owned by one group
+    // only, declare hot combinations once at startup.
+    template<typename... Owned>
+    void declare_group()
+    {
+        m_rg->group<Owned...>();
+    }
+
+    template<typename... Owned>
+    auto get_group()
+    {
+        return m_rg->group<Owned...>();
     }
 
     template<typename T>
@@ -43,7 +341,9 @@ public:
     T* try_get_single()
     {
         auto view = m_rg->view<T>();
-        return view.template try_get<T>(view.front());
+        auto entity = view.front();
+
+        return entity == entt::null ? nullptr : &view.template get<T>(entity);
     }
 
     template<typename T>
@@ -61,20 +361,531 @@ public:
     template<typename T>
     bool erase_resource()
     {
+        s_resource_epoch.fetch_add(1, std::memory_order_relaxed);
         return m_rg->ctx().erase<T>();
     }
 
+    // scratch memory for the calling thread that is released at the start of
+    // the next frame. use it with `std::pmr` containers for temporaries.
+    frame_arena_t* get_frame_arena()
+    {
+        return m_rg->ctx().get<frame_arena_pool_t*>()->get_arena();
+    }
+
+    // deferred spawn/destroy/emplace/remove for the calling thread. safe to
+    // use while iterating a view or from a worker thread, the commands are
+    // applied by the app at its next sync point.
+    command_buffer_t* get_commands()
+    {
+        return m_rg->ctx().get<command_buffer_pool_t*>()->get_buffer();
+    }
+
+    // components have to be registered before snapshots save or restore
+    // them, see `snapshot_schema_t`.
+    template<typename T>
+    void register_snapshot_component()
+    {
+        if (!try_get_resource<snapshot_schema_t>())
+            put_resource<snapshot_schema_t>();
+
+        get_resource<snapshot_schema_t>().register_component<T>();
+    }
+
+    std::expected<void, std::string> save_snapshot(const fs::path& path)
+    {
+        if (auto schema = try_get_resource<snapshot_schema_t>())
+            return schema->save(m_rg, path);
+
+        return snapshot_schema_t {}.save(m_rg, path);
+    }
+
+    // replaces every entity with the ones stored in the snapshot. don't call
+    // it while iterating a view.
+    std::expected<void, std::string> load_snapshot(const fs::path& path)
+    {
+        if (auto schema = try_get_resource<snapshot_schema_t>())
+            return schema->load(m_rg, path);
+
+        return snapshot_schema_t {}.load(m_rg, path);
+    }
+
+    // the wrapped registry, for storage level work (signals, sorting) that
+    // has no wrapper here.
+    entt::registry* get_native()
+    {
+        return m_rg;
+    }
+
+    // bumped every time a resource is added or removed. the context may move
+    // its elements around when that happens, so anything caching a pointer to
+    // a resource has to resolve it again once the epoch changes.
+    static uint64_t get_resource_epoch()
+    {
+        return s_resource_epoch.load(std::memory_order_relaxed);
+    }
+
+    // tracked components are stamped with the current tick. the app advances
+    // it after every system run, so whatever is stamped once a system
+    // returned is newer than that system's last run, its own changes aren't.
+    static uint64_t get_change_tick()
+    {
+        return s_change_tick.load(std::memory_order_relaxed);
+    }
+
+    static uint64_t advance_change_tick()
+    {
+        return s_change_tick.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+private:
+    template<typename T>
+    void insert_components(std::span<entt::entity> entities, const T& arg)
+    {
+        if constexpr (std::ranges::sized_range<T>) {
+            using component_t = std::ranges::range_value_t<T>;
+
+            ENTT_ASSERT(std::ranges::size(arg) >= entities.size(),
+                        "not enough components for the spawned entities");
+            m_rg->insert<component_t>(
+                entities.begin(), entities.end(), std::ranges::begin(arg));
+        } else {
+            m_rg->insert<T>(entities.begin(), entities.end(), arg);
+        }
+    }
+
+    template<typename T>
+    static void on_tracked_added(entt::registry& rg, entt::entity entity)
+    {
+        auto tick = get_change_tick();
+        rg.emplace_or_replace<change_ticks_t<T>>(entity, tick, tick);
+    }
+
+    template<typename T>
+    static void on_tracked_changed(entt::registry& rg, entt::entity entity)
+    {
+        if (auto ticks = rg.try_get<change_ticks_t<T>>(entity))
+            ticks->changed = get_change_tick();
+    }
+
+    template<typename T>
+    static void on_tracked_removed(entt::registry& rg, entt::entity entity)
+    {
+        rg.remove<change_ticks_t<T>>(entity);
+    }
+
 private:
     entt::registry* m_rg;
+    uint64_t m_last_run;
+
+    static inline std::atomic<uint64_t> s_resource_epoch { 1 };
+    static inline std::atomic<uint64_t> s_change_tick { 1 };
 };
 
 using SystemResult = std::expected<void, std::string>;
 using GenericSystem = std::function<SystemResult(registry_t)>;
 using UpdateSystem = std::function<SystemResult(registry_t, float)>;
 
+// typed system parameter that borrows a resource from the registry context.
+// a `const T` resource is only read by the system.
+template<typename T>
+class resource_t {
+public:
+    resource_t(T* resource)
+        : m_resource(resource)
+    {
+    }
+
+    T& operator*() const
+    {
+        return *m_resource;
+    }
+
+    T* operator->() const
+    {
+        return m_resource;
+    }
+
+private:
+    T* m_resource;
+};
+
+// typed system parameter that iterates every entity holding all of the given
+// components. a `const T` component is only read by the system.
+template<bool Filtered, typename... T>
+struct query_base_t {
+    using type = decltype(std::declval<entt::registry&>().view<T...>());
+};
+
+template<typename... T>
+struct query_base_t<true, T...> {
+    using type = filtered_view_t<T...>;
+};
+
+// `added_t` and `changed_t` filters compare against the last run of the
+// system.
+template<typename... T>
+class query_t : public query_base_t<has_change_filter_v<T...>, T...>::type {
+public:
+    using base_type = query_base_t<has_change_filter_v<T...>, T...>::type;
+    using view_type = change_view_t<T...>;
+
+    query_t(const base_type& base)
+        : base_type(base)
+    {
+    }
+};
+
+// typed system parameter for an owning group, see
+// `registry_t::declare_group`.
+template<typename... T>
+class group_t : public decltype(std::declval<entt::registry&>().group<T...>()) {
+public:
+    using group_type = decltype(std::declval<entt::registry&>().group<T...>());
+
+    group_t(const group_type& group)
+        : group_type(group)
+    {
+    }
+
+    // calls `func(std::span<T>...)` for every run of components that is
+    // contiguous in memory. the spans of one call are index aligned, element
+    // `i` of each span belongs to the same entity.
+    template<typename Func>
+    void each_chunk(Func func) const
+    {
+        constexpr size_t page_size = std::min(
+            { entt::component_traits<std::remove_const_t<T>>::page_size... });
+
+        static_assert(
+            ((entt::component_traits<std::remove_const_t<T>>::page_size
+              == page_size)
+             && ...),
+            "owned components must share the same page size");
+        static_assert(page_size != 0, "empty components have no storage");
+
+        auto length = this->size();
+        for (size_t offset = 0; offset < length; offset += page_size) {
+            auto count = std::min(page_size, length - offset);
+            auto page = offset / page_size;
+
+            func(std::span<T>(this->template storage<T>()->raw()[page],
+                              count)...);
+        }
+    }
+};
+
+// what a system touches, described by the component and resource types it
+// reads and writes. a system taking a `registry_t` can touch anything and is
+// marked as exclusive.
+struct system_access_t {
+    std::vector<entt::id_type> reads;
+    std::vector<entt::id_type> writes;
+
+    bool exclusive { false };
+};
+
+template<typename T>
+struct system_param_t {
+    static_assert(!sizeof(T), "unsupported system parameter type");
+};
+
+template<>
+struct system_param_t<registry_t> {
+    struct state_t {
+        uint64_t last_run { 0 };
+    };
+
+    static registry_t fetch(state_t& state, entt::registry* rg, float)
+    {
+        registry_t result(rg, state.last_run);
+        state.last_run = registry_t::get_change_tick();
+
+        return result;
+    }
+
+    static void describe(system_access_t* access)
+    {
+        access->exclusive = true;
+    }
+};
+
+template<>
+struct system_param_t<float> {
+    struct state_t { };
+
+    static float fetch(state_t&, entt::registry*, float dt)
+    {
+        return dt;
+    }
+
+    static void describe(system_access_t*)
+    {
+    }
+};
+
+// subset of the entities a system with `system_options_t::slices` handles
+// in the current run. other systems always get the whole set.
+struct system_slice_t {
+    uint32_t index { 0 };
+    uint32_t count { 1 };
+
+    bool contains(entt::entity entity) const
+    {
+        return entt::to_entity(entity) % count == index;
+    }
+};
+
+template<>
+struct system_param_t<system_slice_t> {
+    struct state_t { };
+
+    static system_slice_t fetch(state_t&, entt::registry* rg, float)
+    {
+        if (auto slice = rg->ctx().find<system_slice_t>())
+            return *slice;
+
+        return {};
+    }
+
+    static void describe(system_access_t*)
+    {
+    }
+};
+
+template<typename T>
+struct system_param_t<resource_t<T>> {
+    struct state_t {
+        T* resource { nullptr };
+        uint64_t epoch { 0 };
+    };
+
+    static resource_t<T> fetch(state_t& state, entt::registry* rg, float)
+    {
+        if (auto epoch = registry_t::get_resource_epoch();
+            state.epoch != epoch) {
+            state.resource = &rg->ctx().get<std::remove_const_t<T>>();
+            state.epoch = epoch;
+        }
+
+        return state.resource;
+    }
+
+    static void describe(system_access_t* access)
+    {
+        auto id = entt::type_hash<std::remove_const_t<T>>::value();
+
+        if constexpr (std::is_const_v<T>)
+            access->reads.push_back(id);
+        else
+            access->writes.push_back(id);
+    }
+};
+
+template<typename... T>
+struct system_param_t<query_t<T...>> {
+    struct state_t {
+        std::optional<typename query_t<T...>::view_type> view;
+        uint64_t last_run { 0 };
+    };
+
+    static query_t<T...> fetch(state_t& state, entt::registry* rg, float)
+    {
+        if (!state.view) {
+            state.view = rg->view<typename change_filter_t<T>::view_type...>();
+        } else if constexpr (sizeof...(T) > 1) {
+            // pick the smallest storage again, the sizes may have changed
+            // since the last run.
+            state.view->refresh();
+        }
+
+        if constexpr (has_change_filter_v<T...>) {
+            auto since = state.last_run;
+            state.last_run = registry_t::get_change_tick();
+
+            return filtered_view_t<T...>(*state.view, since);
+        } else {
+            return *state.view;
+        }
+    }
+
+    static void describe(system_access_t* access)
+    {
+        auto add = [access]<typename C>() {
+            auto id = entt::type_hash<std::remove_const_t<C>>::value();
+
+            if constexpr (std::is_const_v<C>)
+                access->reads.push_back(id);
+            else
+                access->writes.push_back(id);
+        };
+
+        // filters read the ticks of their component.
+        (add.template operator()<typename change_filter_t<T>::view_type>(),
+         ...);
+    }
+};
+
+template<typename... T>
+struct system_param_t<group_t<T...>> {
+    struct state_t {
+        std::optional<typename group_t<T...>::group_type> group;
+    };
+
+    static group_t<T...> fetch(state_t& state, entt::registry* rg, float)
+    {
+        if (!state.group)
+            state.group = rg->group<T...>();
+
+        return *state.group;
+    }
+
+    static void describe(system_access_t* access)
+    {
+        system_param_t<query_t<T...>>::describe(access);
+    }
+};
+
+// type erased system. the call goes through one plain function pointer into
+// a thunk that knows the concrete system, so typed systems are called directly
+// with parameters resolved from state cached across runs.
+class erased_system_t {
+public:
+    using Invoke = SystemResult (*)(void* state, entt::registry* rg, float dt);
+
+    erased_system_t(Invoke invoke,
+                    std::unique_ptr<void, void (*)(void*)> state,
+                    system_access_t access,
+                    std::string_view name = {})
+        : m_invoke(invoke)
+        , m_state(std::move(state))
+        , m_access(std::move(access))
+        , m_name(name)
+    {
+    }
+
+    erased_system_t(erased_system_t&& other)
+        : m_invoke(other.m_invoke)
+        , m_state(std::move(other.m_state))
+        , m_access(std::move(other.m_access))
+        , m_name(other.m_name)
+    {
+    }
+
+    erased_system_t(const erased_system_t& other) = delete;
+
+    SystemResult operator()(entt::registry* rg, float dt) const
+    {
+        return m_invoke(m_state.get(), rg, dt);
+    }
+
+    const system_access_t& get_access() const
+    {
+        return m_access;
+    }
+
+    // name of the function behind a typed system, empty otherwise.
+    std::string_view get_name() const
+    {
+        return m_name;
+    }
+
+private:
+    Invoke m_invoke;
+    std::unique_ptr<void, void (*)(void*)> m_state;
+    system_access_t m_access;
+    std::string_view m_name;
+};
+
+template<auto System>
+constexpr std::string_view get_system_name()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    std::string_view name = __FUNCSIG__;
+    auto start = name.find("get_system_name<") + 16;
+    auto end = name.rfind(">(void)");
+#else
+    std::string_view name = __PRETTY_FUNCTION__;
+    auto start = name.find("System = ") + 9;
+    auto end = name.find_first_of(";]", start);
+#endif
+    name = name.substr(start, end - start);
+
+    if (name.starts_with('&'))
+        name.remove_prefix(1);
+
+    return name;
+}
+
+template<typename T>
+erased_system_t make_erased_system(T system)
+{
+    auto invoke = [](void* state, entt::registry* rg, float dt) {
+        if constexpr (std::is_invocable_v<T&, registry_t, float>)
+            return (*static_cast<T*>(state))(rg, dt);
+        else
+            return (*static_cast<T*>(state))(rg);
+    };
+
+    auto destroy = [](void* state) { delete static_cast<T*>(state); };
+
+    return { invoke,
+             { new T(std::move(system)), destroy },
+             { .exclusive = true } };
+}
+
+template<auto System, typename Result, typename... Params>
+erased_system_t make_erased_system(Result (*)(Params...))
+{
+    using state_t
+        = std::tuple<typename system_param_t<std::remove_cvref_t<Params>>::
+                         state_t...>;
+
+    auto invoke = [](void* state, entt::registry* rg, float dt) {
+        auto& params = *static_cast<state_t*>(state);
+
+        return [&]<size_t... I>(std::index_sequence<I...>) -> SystemResult {
+            if constexpr (std::is_void_v<Result>) {
+                System(system_param_t<std::remove_cvref_t<Params>>::fetch(
+                    std::get<I>(params), rg, dt)...);
+                return {};
+            } else {
+                return System(
+                    system_param_t<std::remove_cvref_t<Params>>::fetch(
+                        std::get<I>(params), rg, dt)...);
+            }
+        }(std::index_sequence_for<Params...> {});
+    };
+
+    auto destroy = [](void* state) { delete static_cast<state_t*>(state); };
+
+    system_access_t access;
+    (system_param_t<std::remove_cvref_t<Params>>::describe(&access), ...);
+
+    return { invoke,
+             { new state_t(), destroy },
+             std::move(access),
+             get_system_name<System>() };
+}
+
+// builds a system whose parameter list declares what it needs, e.g.
+// `SystemResult update(resource_t<const window_creation_info_t> info,
+//                      query_t<quad_2d_t, const velocity_t> quads,
+//                      float dt)`.
+// accepts functions and captureless lambdas.
+template<auto System>
+erased_system_t make_erased_system()
+{
+    return make_erased_system<System>(+System);
+}
+
 class startup_system_t {
 public:
     startup_system_t(GenericSystem system)
+        : m_system(make_erased_system(std::move(system)))
+    {
+    }
+
+    startup_system_t(erased_system_t system)
         : m_system(std::move(system))
     {
     }
@@ -88,18 +899,39 @@ public:
 
     SystemResult operator()(entt::registry* rg) const
     {
-        return m_system(rg);
+        return m_system(rg, 0.0f);
+    }
+
+    const system_access_t& get_access() const
+    {
+        return m_system.get_access();
+    }
+
+    std::string_view get_name() const
+    {
+        return m_system.get_name();
     }
 
 private:
-    GenericSystem m_system;
+    erased_system_t m_system;
 };
 
 startup_system_t make_startup(GenericSystem system);
 
+template<auto System>
+startup_system_t make_startup()
+{
+    return { make_erased_system<System>() };
+}
+
 class shutdown_system_t {
 public:
     shutdown_system_t(GenericSystem system)
+        : m_system(make_erased_system(std::move(system)))
+    {
+    }
+
+    shutdown_system_t(erased_system_t system)
         : m_system(std::move(system))
     {
     }
@@ -113,18 +945,39 @@ public:
 
     SystemResult operator()(entt::registry* rg) const
     {
-        return m_system(rg);
+        return m_system(rg, 0.0f);
+    }
+
+    const system_access_t& get_access() const
+    {
+        return m_system.get_access();
+    }
+
+    std::string_view get_name() const
+    {
+        return m_system.get_name();
     }
 
 private:
-    GenericSystem m_system;
+    erased_system_t m_system;
 };
 
 shutdown_system_t make_shutdown(GenericSystem system);
 
+template<auto System>
+shutdown_system_t make_shutdown()
+{
+    return { make_erased_system<System>() };
+}
+
 class update_system_t {
 public:
     update_system_t(UpdateSystem system)
+        : m_system(make_erased_system(std::move(system)))
+    {
+    }
+
+    update_system_t(erased_system_t system)
         : m_system(std::move(system))
     {
     }
@@ -141,15 +994,36 @@ public:
         return m_system(rg, dt);
     }
 
+    const system_access_t& get_access() const
+    {
+        return m_system.get_access();
+    }
+
+    std::string_view get_name() const
+    {
+        return m_system.get_name();
+    }
+
 private:
-    UpdateSystem m_system;
+    erased_system_t m_system;
 };
 
 update_system_t make_update(UpdateSystem system);
 
+template<auto System>
+update_system_t make_update()
+{
+    return { make_erased_system<System>() };
+}
+
 class fixed_update_system_t {
 public:
     fixed_update_system_t(UpdateSystem system)
+        : m_system(make_erased_system(std::move(system)))
+    {
+    }
+
+    fixed_update_system_t(erased_system_t system)
         : m_system(std::move(system))
     {
     }
@@ -166,8 +1040,24 @@ public:
         return m_system(rg, dt);
     }
 
+    const system_access_t& get_access() const
+    {
+        return m_system.get_access();
+    }
+
+    std::string_view get_name() const
+    {
+        return m_system.get_name();
+    }
+
 private:
-    UpdateSystem m_system;
+    erased_system_t m_system;
 };
 
 fixed_update_system_t make_fixed_update(UpdateSystem system);
+
+template<auto System>
+fixed_update_system_t make_fixed_update()
+{
+    return { make_erased_system<System>() };
+}
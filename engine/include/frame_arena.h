@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "per_thread.h"
+
+// linear allocator for memory that only has to live until the end of the
+// current frame. deallocation is a no-op, everything is released at once by
+// `reset()`.
+class frame_arena_t : public std::pmr::memory_resource {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 1 << 20;
+
+    frame_arena_t(size_t block_size = DEFAULT_BLOCK_SIZE);
+
+    virtual ~frame_arena_t() override;
+
+    frame_arena_t(const frame_arena_t& other) = delete;
+    frame_arena_t& operator=(const frame_arena_t& other) = delete;
+
+    void reset();
+
+    size_t get_used_bytes() const;
+
+    size_t get_capacity() const;
+
+private:
+    virtual void* do_allocate(size_t bytes, size_t alignment) override;
+
+    virtual void
+    do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+
+    virtual bool
+    do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    std::byte* allocate_block(size_t size);
+
+    void release_blocks();
+
+private:
+    struct block_t {
+        std::byte* data;
+        size_t size;
+    };
+
+    std::vector<block_t> m_blocks;
+
+    size_t m_block_size;
+    size_t m_current_block { 0 };
+    size_t m_offset { 0 };
+    size_t m_used { 0 };
+};
+
+// owns one `frame_arena_t` per thread that asked for one. `reset()` must only
+// be called while no other thread is allocating from the pool.
+class frame_arena_pool_t {
+public:
+    frame_arena_t* get_arena();
+
+    void reset();
+
+private:
+    per_thread_t<frame_arena_t> m_arenas;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// pixels of a rendered frame as rgba8, rows from the bottom up like gl
+// returns them.
+struct captured_frame_t {
+    uint64_t frame;
+
+    int32_t width;
+    int32_t height;
+
+    std::vector<uint8_t> pixels;
+};
+
+// a renderer with `on_frame` set draws into an offscreen framebuffer and
+// reads every `interval`th frame back without stalling on the gpu.
+struct frame_capture_settings_t {
+    // called on a worker thread in frame order, e.g. to encode the frame.
+    std::function<void(captured_frame_t)> on_frame;
+
+    uint32_t interval { 1 };
+};
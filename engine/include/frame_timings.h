@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct timing_t {
+    std::string name;
+
+    float cpu_ms { 0.0f };
+    float gpu_ms { 0.0f };
+};
+
+// timings of the last frame, available as a `frame_timings_t*` resource. the
+// app fills in the cpu time of every update and fixed update system, the
+// renderers add the gpu time of their passes, which lags a few frames behind
+// since it is read back without stalling.
+struct frame_timings_t {
+    float frame_ms { 0.0f };
+
+    std::vector<timing_t> systems;
+    std::vector<timing_t> passes;
+
+    timing_t* find_pass(std::string_view name)
+    {
+        for (auto& pass : passes) {
+            if (pass.name == name)
+                return &pass;
+        }
+
+        return &passes.emplace_back(std::string(name));
+    }
+};
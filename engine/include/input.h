@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <SDL3/SDL_keycode.h>
+#include <SDL3/SDL_mouse.h>
+#include <SDL3/SDL_scancode.h>
+
+#include <glm/glm.hpp>
+
+enum class input_event_type_t : uint8_t {
+    quit,
+    key_down,
+    key_up,
+    mouse_motion,
+    mouse_button_down,
+    mouse_button_up,
+    mouse_wheel,
+    window_resized,
+};
+
+// copy of the sdl event with the fields the engine uses, only the fields of
+// its type are set.
+struct input_event_t {
+    input_event_type_t type;
+
+    uint64_t timestamp_ns { 0 };
+
+    SDL_Keycode key { SDLK_UNKNOWN };
+    SDL_Scancode scancode { SDL_SCANCODE_UNKNOWN };
+    bool repeat { false };
+
+    uint8_t button { 0 };
+
+    // the motion of `mouse_motion` and the scroll amount of `mouse_wheel`
+    // are in `delta`.
+    glm::vec2 position { 0.0f };
+    glm::vec2 delta { 0.0f };
+
+    // the new size of `window_resized` in pixels, 0 while minimized.
+    glm::ivec2 size { 0 };
+};
+
+// events of the current frame, available as a resource. the window fills the
+// back buffer and swaps it in at the start of every frame, so systems only
+// read the front buffer and never need a lock. fixed update systems run
+// before the swap and see the events of the previous frame.
+class input_events_t {
+public:
+    std::span<const input_event_t> get_events() const
+    {
+        return m_buffers[m_front];
+    }
+
+    void push(const input_event_t& event)
+    {
+        m_buffers[m_front ^ 1].push_back(event);
+    }
+
+    // the back buffer becomes the front, the old front is cleared for new
+    // events.
+    void swap()
+    {
+        m_front ^= 1;
+        m_buffers[m_front ^ 1].clear();
+    }
+
+private:
+    std::array<std::vector<input_event_t>, 2> m_buffers;
+    uint32_t m_front { 0 };
+};
+
+// keyboard and mouse state of the current frame, available as a resource.
+struct input_state_t {
+    std::array<uint8_t, SDL_SCANCODE_COUNT> keys_down {};
+
+    // keys that went down or up during the frame.
+    std::array<uint8_t, SDL_SCANCODE_COUNT> keys_pressed {};
+    std::array<uint8_t, SDL_SCANCODE_COUNT> keys_released {};
+
+    SDL_MouseButtonFlags mouse_buttons { 0 };
+
+    glm::vec2 mouse_position { 0.0f };
+
+    // relative motion and scroll amount since the previous frame.
+    glm::vec2 mouse_delta { 0.0f };
+    glm::vec2 wheel_delta { 0.0f };
+
+    // motion sampled late in the frame. the 3d renderer turns a mouse look
+    // camera by it, whatever is left is added to the next `mouse_delta`.
+    glm::vec2 late_mouse_delta { 0.0f };
+
+    bool is_key_down(SDL_Scancode key) const
+    {
+        return keys_down[key];
+    }
+
+    bool was_key_pressed(SDL_Scancode key) const
+    {
+        return keys_pressed[key];
+    }
+
+    bool was_key_released(SDL_Scancode key) const
+    {
+        return keys_released[key];
+    }
+};
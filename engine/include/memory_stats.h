@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct memory_usage_t {
+    std::string name;
+
+    uint64_t total_allocations { 0 };
+    uint64_t frame_allocations { 0 };
+
+    int64_t live_bytes { 0 };
+    int64_t peak_bytes { 0 };
+};
+
+// snapshot of every memory scope, refreshed by the app at the end of each
+// frame and available as a resource.
+struct memory_stats_t {
+    std::vector<memory_usage_t> scopes;
+
+    bool heap_tracking { false };
+};
+
+// attributes memory to scopes. heap allocations are charged to the scope
+// that is current on the allocating thread, which the app sets to the system
+// being run. heap tracking replaces the global allocation functions and is
+// only compiled in with `FENGINE_MEMORY_TRACKING`, gpu memory is reported
+// explicitly by the code creating the resources and is always tracked.
+class memory_tracker_t {
+public:
+    static constexpr uint32_t ENGINE_SCOPE = 0;
+    static constexpr uint32_t GPU_BUFFER_SCOPE = 1;
+    static constexpr uint32_t GPU_TEXTURE_SCOPE = 2;
+
+    static constexpr uint32_t MAX_SCOPES = 256;
+
+    static uint32_t register_scope(std::string_view name);
+
+    // makes `scope` current on the calling thread and returns the previous
+    // one.
+    static uint32_t set_scope(uint32_t scope);
+
+    static void track_gpu(uint32_t scope, int64_t bytes);
+
+    static bool is_heap_tracking_enabled();
+
+    static void collect(memory_stats_t* stats);
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// lazily creates one `T` per thread that asks for it. lookups from a thread
+// that already has its instance only touch a thread local cache.
+template<typename T>
+class per_thread_t {
+public:
+    per_thread_t()
+        : m_id(s_next_id.fetch_add(1, std::memory_order_relaxed))
+    {
+    }
+
+    per_thread_t(const per_thread_t& other) = delete;
+    per_thread_t& operator=(const per_thread_t& other) = delete;
+
+    T* local()
+    {
+        if (t_cache.owner == m_id)
+            return t_cache.value;
+
+        std::lock_guard lock(m_mutex);
+
+        auto thread = std::this_thread::get_id();
+
+        T* value = nullptr;
+        for (const auto& entry : m_entries) {
+            if (entry.thread == thread) {
+                value = entry.value.get();
+                break;
+            }
+        }
+
+        if (!value) {
+            m_entries.push_back(
+                { .thread = thread, .value = std::make_unique<T>() });
+            value = m_entries.back().value.get();
+        }
+
+        t_cache = { .owner = m_id, .value = value };
+        return value;
+    }
+
+    // visits every instance in the order the threads first asked for them.
+    template<typename Func>
+    void for_each(Func&& func)
+    {
+        std::lock_guard lock(m_mutex);
+
+        for (auto& entry : m_entries)
+            func(*entry.value);
+    }
+
+private:
+    struct entry_t {
+        std::thread::id thread;
+        std::unique_ptr<T> value;
+    };
+
+    struct cache_t {
+        uint64_t owner { 0 };
+        T* value { nullptr };
+    };
+
+    std::mutex m_mutex;
+    std::vector<entry_t> m_entries;
+
+    uint64_t m_id;
+
+    static inline std::atomic<uint64_t> s_next_id { 1 };
+    static inline thread_local cache_t t_cache;
+};
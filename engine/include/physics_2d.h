@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <app.h>
+#include <fecs.h>
+#include <renderer_2d.h>
+
+#include <glm/glm.hpp>
+
+enum class collider_shape_2d_t : uint8_t {
+    aabb,
+    circle,
+};
+
+// makes the `quad_2d_t` of an entity a physics body. the quad is the body's
+// collider, circles use the largest circle that fits in the quad.
+struct rigid_body_2d_t {
+    glm::vec2 velocity { 0.0f };
+
+    // 0 makes the body static.
+    float inverse_mass { 1.0f };
+    float restitution { 1.0f };
+
+    collider_shape_2d_t shape { collider_shape_2d_t::aabb };
+};
+
+struct physics_2d_settings_t {
+    glm::vec2 gravity { 0.0f };
+
+    // bodies bounce off the bounds when `use_bounds` is set.
+    bool use_bounds { false };
+    glm::vec2 bounds_min { 0.0f };
+    glm::vec2 bounds_max { 0.0f };
+
+    // size of a broadphase grid cell, 0 derives it from the average body
+    // size every step.
+    float cell_size { 0.0f };
+};
+
+struct contact_2d_t {
+    entt::entity a;
+    entt::entity b;
+
+    // points from `a` to `b`.
+    glm::vec2 normal;
+    float depth;
+};
+
+// state of the simulation, available as a resource. contacts are those of
+// the last fixed step.
+struct physics_world_2d_t {
+    physics_2d_settings_t settings;
+
+    std::vector<contact_2d_t> contacts;
+
+    // bodies of the current step as structure of arrays, positions are the
+    // centers of the quads. kept between steps so stepping doesn't allocate.
+    struct bodies_t {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> velocity_x;
+        std::vector<float> velocity_y;
+        std::vector<float> half_width;
+        std::vector<float> half_height;
+        std::vector<float> inverse_mass;
+        std::vector<float> restitution;
+        std::vector<collider_shape_2d_t> shape;
+    } bodies;
+
+    // broadphase grid, bucket `i` holds the bodies in
+    // `cell_bodies[cell_start[i]..cell_start[i + 1]]`.
+    std::vector<uint32_t> cell_start;
+    std::vector<uint32_t> cell_bodies;
+
+    // the last body added to each bucket, so a body whose cells share a
+    // bucket is only added to it once.
+    std::vector<uint32_t> cell_last_body;
+
+    // body indices of every contact, two per contact.
+    std::vector<uint32_t> contact_bodies;
+};
+
+// simulates every entity with a `quad_2d_t` and a `rigid_body_2d_t` in a fixed
+// update system. both components are owned by a group, so they can't be
+// owned by another one.
+class physics_2d_t : public plugin_t {
+public:
+    physics_2d_t(physics_2d_settings_t settings = {});
+
+    virtual ~physics_2d_t() override = default;
+
+    virtual PluginResult build(app_t* app) override;
+
+    static SystemResult setup(registry_t rg);
+
+    static SystemResult step(resource_t<physics_world_2d_t> world,
+                             group_t<quad_2d_t, rigid_body_2d_t> bodies,
+                             float dt);
+
+private:
+    physics_2d_settings_t m_settings;
+};
@@ -1,9 +1,16 @@
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include <app.h>
 #include <fecs.h>
+#include <frame_capture.h>
 #include <window_sdl.h>
 
+#include <frame_uniforms/frame_uniforms.h>
+#include <gpu_timer/gpu_timer.h>
+#include <readback/readback.h>
 #include <shader/shader.h>
 
 #include <glm/glm.hpp>
@@ -26,19 +33,31 @@ struct quad_vertex_t {
 struct render_data_2d_t {
     shader_t shader;
 
+    frame_uniform_buffer_t frame_uniforms;
+    glm::vec2 viewport_size { 1.0f };
+    float time { 0.0f };
+
     uint32_t quad_vao;
     uint32_t quad_vbo;
     uint32_t quad_ebo;
 
-    quad_vertex_t* quad_vertices;
-    quad_vertex_t* quad_vertices_ptr;
+    // vertices of the frame, four per quad. submitted at the end of it.
+    std::vector<quad_vertex_t> quad_vertices;
+
+    // quads the vertex buffer has room for, and the frames in a row a
+    // quarter of it was enough.
+    size_t quad_capacity { 0 };
+    uint32_t idle_frames { 0 };
+
+    gpu_timer_t gpu_timer;
 
-    uint32_t quad_index_count { 0 };
+    // set while frames are captured.
+    std::unique_ptr<readback_ring_t> readback;
 };
 
 class renderer_2d_t : public plugin_t {
 public:
-    renderer_2d_t(window_sdl_t window);
+    renderer_2d_t(window_sdl_t window, frame_capture_settings_t capture = {});
 
     virtual ~renderer_2d_t() override = default;
 
@@ -46,14 +65,22 @@ public:
 
     static SystemResult setup(registry_t rg);
 
-    static SystemResult begin_drawing(registry_t rg, float);
+    // follows window resizes and uploads the frame uniforms.
+    static SystemResult begin_drawing(resource_t<render_data_2d_t> rd,
+                                      resource_t<const input_events_t> events,
+                                      float dt);
 
-    static SystemResult fetch_quads(registry_t rg, float);
+    static SystemResult fetch_quads(resource_t<render_data_2d_t> rd,
+                                    query_t<const quad_2d_t> quads);
 
-    static SystemResult end_drawing(registry_t rg, float);
+    static SystemResult
+    end_drawing(resource_t<const sdl_context_t> sdl_context,
+                resource_t<render_data_2d_t> rd,
+                resource_t<frame_timings_t*> timings);
 
     static SystemResult shutdown(registry_t rg);
 
 private:
     window_sdl_t m_window;
+    frame_capture_settings_t m_capture;
 };
\ No newline at end of file
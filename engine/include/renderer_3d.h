@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <app.h>
+#include <asset_manager.h>
+#include <fecs.h>
+#include <transform.h>
+#include <window_sdl.h>
+
+#include <bvh/bvh.h>
+#include <camera/camera.h>
+#include <frame_uniforms/frame_uniforms.h>
+#include <gpu_timer/gpu_timer.h>
+#include <light_clusters/light_clusters.h>
+#include <shader/shader.h>
+
+#include <glm/glm.hpp>
+
+// draws `model` at the `world_transform_t` of the entity, entities without
+// one aren't drawn. the model is acquired from the asset manager while the
+// entity has both components.
+struct model_instance_t {
+    model_handle_t model;
+};
+
+// lights models within `radius` of the position of the `world_transform_t`
+// of the entity.
+struct point_light_t {
+    glm::vec3 color { 1.0f };
+    float intensity { 1.0f };
+    float radius { 5.0f };
+};
+
+// layout of a light in the light buffer of the shader, in view space.
+struct gpu_point_light_t {
+    glm::vec4 position_radius;
+    glm::vec4 color;
+};
+
+// entities sharing a model. the instance transforms of a batch are written
+// contiguously and every mesh of the model is drawn with one instanced draw.
+struct instance_batch_t {
+    model_handle_t model;
+    std::vector<entt::entity> entities;
+};
+
+// batches are kept up to date as `model_instance_t` components are added,
+// replaced and removed, entities are never searched for. they only hold
+// entities that also have a `world_transform_t`.
+struct instance_batches_t {
+    static constexpr uint32_t NO_BATCH = UINT32_MAX;
+
+    struct slot_t {
+        uint32_t batch { NO_BATCH };
+        uint32_t index { 0 };
+    };
+
+    std::vector<instance_batch_t> batches;
+    std::unordered_map<uint64_t, uint32_t> lookup;
+
+    // by entity index.
+    std::vector<slot_t> slots;
+
+    // changes whenever an instance is added or removed.
+    uint64_t version { 0 };
+};
+
+struct render_data_3d_t {
+    shader_t shader;
+
+    // invalidated and refilled every frame.
+    uint32_t instance_vbo;
+    size_t instance_capacity { 0 };
+
+    float fov { 45.0f };
+    glm::vec2 viewport_size { 1.0f };
+    float time { 0.0f };
+
+    // uploaded by `cull_instances` once the camera of the frame is known.
+    frame_uniform_buffer_t frame_uniforms;
+    frame_uniforms_t frame;
+
+    glm::mat4 view { 1.0f };
+    glm::mat4 view_projection { 1.0f };
+
+    // world bounds of every instance in batch order, the bvh is built over
+    // them and rebuilt when the batches change.
+    bvh_t bvh;
+    uint64_t bvh_version { UINT64_MAX };
+    std::vector<aabb_t> instance_bounds;
+
+    // by instance, and how many instances of every batch are visible.
+    std::vector<uint8_t> visible;
+    std::vector<uint32_t> visible_counts;
+
+    // lights are assigned to clusters on the cpu, the shader reads the lights
+    // of its cluster from three storage buffers.
+    light_clusters_t light_clusters;
+    glm::mat4 light_projection { 0.0f };
+
+    std::vector<glm::vec4> light_spheres;
+    std::vector<gpu_point_light_t> gpu_lights;
+
+    uint32_t light_ssbo;
+    uint32_t cluster_offset_ssbo;
+    uint32_t light_index_ssbo;
+
+    size_t light_capacity { 0 };
+    size_t cluster_offset_capacity { 0 };
+    size_t light_index_capacity { 0 };
+
+    gpu_timer_t gpu_timer;
+};
+
+// renders `model_instance_t` entities lit by `point_light_t` entities. add
+// the asset and transform plugins before this one so assets are loaded and
+// world transforms are computed before drawing. the view is taken from the
+// `camera_t` resource.
+class renderer_3d_t : public plugin_t {
+public:
+    renderer_3d_t(window_sdl_t window);
+
+    virtual ~renderer_3d_t() override = default;
+
+    virtual PluginResult build(app_t* app) override;
+
+    static SystemResult setup(registry_t rg);
+
+    // follows window resizes.
+    static SystemResult begin_drawing(resource_t<render_data_3d_t> rd,
+                                      resource_t<const input_events_t> events,
+                                      float dt);
+
+    // frustum culls the instances against the `camera_t` resource, only the
+    // visible ones are drawn. a camera that follows the mouse is first turned
+    // by the motion late input sampling picked up.
+    static SystemResult
+    cull_instances(resource_t<render_data_3d_t> rd,
+                   resource_t<const instance_batches_t> batches,
+                   resource_t<asset_manager_t> assets,
+                   resource_t<camera_t> camera,
+                   resource_t<input_state_t> input,
+                   query_t<const world_transform_t> transforms);
+
+    // assigns lights to clusters with the view of `cull_instances` and
+    // uploads the result for the shader.
+    static SystemResult
+    cull_lights(resource_t<render_data_3d_t> rd,
+                resource_t<const camera_t> camera,
+                query_t<const point_light_t, const world_transform_t> lights);
+
+    static SystemResult
+    draw_instances(resource_t<render_data_3d_t> rd,
+                   resource_t<const instance_batches_t> batches,
+                   resource_t<asset_manager_t> assets,
+                   query_t<const world_transform_t> transforms);
+
+    static SystemResult
+    end_drawing(resource_t<const sdl_context_t> sdl_context,
+                resource_t<render_data_3d_t> rd,
+                resource_t<frame_timings_t*> timings);
+
+    static SystemResult shutdown(registry_t rg);
+
+private:
+    window_sdl_t m_window;
+};
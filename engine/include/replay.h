@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <app.h>
+#include <fecs.h>
+#include <input.h>
+
+namespace fs = std::filesystem;
+
+enum class replay_mode_t : uint8_t {
+    record,
+    replay,
+};
+
+struct replay_frame_t {
+    float delta_time;
+    uint32_t event_count;
+
+    SDL_MouseButtonFlags mouse_buttons;
+    glm::vec2 mouse_position;
+    glm::vec2 mouse_delta;
+};
+
+// frame times, input events and random seeds of a session, available as a
+// resource. a replayed session gets the same delta times, input and seeds as
+// the recorded one, so a deterministic simulation plays out the same way.
+class replay_t {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    replay_t(replay_mode_t mode, fs::path path);
+
+    replay_mode_t get_mode() const;
+
+    // seeds for random number generators. recorded seeds are handed out in
+    // the same order when replaying.
+    uint64_t make_seed();
+
+    void record_frame(float delta_time,
+                      std::span<const input_event_t> events,
+                      const input_state_t& state);
+
+    // advances to the next recorded frame, nothing once all were played.
+    std::optional<float> next_frame();
+
+    // fills the input resources with the events of the current frame. the
+    // key state is rebuilt from the key events.
+    void apply_input(input_events_t* events, input_state_t* state) const;
+
+    std::expected<void, std::string> save() const;
+
+    std::expected<void, std::string> load();
+
+private:
+    replay_mode_t m_mode;
+    fs::path m_path;
+
+    std::vector<uint64_t> m_seeds;
+    std::vector<replay_frame_t> m_frames;
+    std::vector<input_event_t> m_events;
+
+    size_t m_next_seed { 0 };
+
+    // the frame being played and the offset of its first event.
+    size_t m_frame { SIZE_MAX };
+    size_t m_event { 0 };
+};
+
+// records a session to `path`, or replays it. when recording, add it after
+// the window or renderer plugin so it sees the input of the frame. when
+// replaying, add it instead of them, before every other plugin, its input
+// takes the place of the window's. to render a replay, e.g. to capture its
+// frames, add it right after a headless renderer with `external_input` set
+// instead.
+class replay_plugin_t : public plugin_t {
+public:
+    replay_plugin_t(replay_mode_t mode, fs::path path);
+
+    virtual ~replay_plugin_t() override = default;
+
+    virtual PluginResult build(app_t* app) override;
+
+    static SystemResult record(resource_t<replay_t> replay,
+                               resource_t<const input_events_t> events,
+                               resource_t<const input_state_t> state,
+                               float dt);
+
+    static SystemResult play(resource_t<const replay_t> replay,
+                             resource_t<input_events_t> events,
+                             resource_t<input_state_t> state);
+
+    static SystemResult shutdown(resource_t<const replay_t> replay);
+
+private:
+    replay_mode_t m_mode;
+    fs::path m_path;
+};
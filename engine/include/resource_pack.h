@@ -0,0 +1,16 @@
+#pragma once
+
+#include <expected>
+#include <filesystem>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// serves the files of a pack built by the `pack` tool instead of the loose
+// files under the working directory. paths are looked up as the loaders
+// spell them, e.g. `resources/shaders/basic.qsh`, files missing from the pack
+// are still read from the disk. mount the pack before loading any asset and
+// keep it mounted while assets loaded from it are alive.
+std::expected<void, std::string> mount_resource_pack(const fs::path& path);
+
+void unmount_resource_pack();
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <entt/entt.hpp>
+
+namespace fs = std::filesystem;
+
+// the set of components that are written to and read from world snapshots.
+// a snapshot stores the entity storage and every registered component storage
+// as flat arrays, so components have to be trivially copyable.
+class snapshot_schema_t {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    template<typename T>
+    void register_component()
+    {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "snapshot components must be trivially copyable");
+        static_assert(std::is_default_constructible_v<T>,
+                      "snapshot components must be default constructible");
+        static_assert(!entt::component_traits<T>::in_place_delete,
+                      "snapshot components must be tightly packed");
+
+        auto id = entt::type_hash<T>::value();
+        for (const auto& component : m_components) {
+            if (component.id == id)
+                return;
+        }
+
+        m_components.push_back({
+            .id = id,
+            .element_size = std::is_empty_v<T> ? 0 : sizeof(T),
+            .page_size = entt::component_traits<T>::page_size,
+            .storage = [](entt::registry* rg) -> entt::sparse_set& {
+                return rg->storage<T>();
+            },
+            .insert =
+                [](entt::registry* rg,
+                   const entt::entity* first,
+                   size_t count) { rg->insert<T>(first, first + count); },
+            .page = [](entt::registry* rg, size_t page) -> std::byte* {
+                if constexpr (std::is_empty_v<T>)
+                    return nullptr;
+                else
+                    return reinterpret_cast<std::byte*>(
+                        rg->storage<T>().raw()[page]);
+            },
+        });
+    }
+
+    // writes every entity and all registered components to `path`.
+    std::expected<void, std::string> save(entt::registry* rg,
+                                          const fs::path& path) const;
+
+    // replaces the content of the registry with the snapshot at `path`.
+    // components that aren't registered are dropped. must not be called while
+    // a view of the registry is being iterated.
+    std::expected<void, std::string> load(entt::registry* rg,
+                                          const fs::path& path) const;
+
+private:
+    struct component_t {
+        entt::id_type id;
+        uint32_t element_size;
+        size_t page_size;
+
+        entt::sparse_set& (*storage)(entt::registry* rg);
+        void (*insert)(entt::registry* rg,
+                       const entt::entity* first,
+                       size_t count);
+        std::byte* (*page)(entt::registry* rg, size_t page);
+    };
+
+    std::vector<component_t> m_components;
+};
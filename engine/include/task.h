@@ -0,0 +1,214 @@
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <expected>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <fecs.h>
+
+class task_scheduler_t;
+
+using TaskResult = std::expected<void, std::string>;
+
+// a coroutine that is started with `task_scheduler_t::spawn`. it runs until
+// it awaits one of the waits below and ends with `co_return {};`, or with an
+// error that stops the app like a failing system does.
+class task_t {
+public:
+    struct promise_type;
+
+    using handle_t = std::coroutine_handle<promise_type>;
+
+    struct final_awaiter_t {
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        // hands the finished task to its scheduler, which destroys it.
+        void await_suspend(handle_t handle) const noexcept;
+
+        void await_resume() const noexcept { }
+    };
+
+    struct promise_type {
+        task_scheduler_t* scheduler { nullptr };
+        TaskResult result;
+
+        task_t get_return_object()
+        {
+            return task_t(handle_t::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() const noexcept
+        {
+            return {};
+        }
+
+        final_awaiter_t final_suspend() const noexcept
+        {
+            return {};
+        }
+
+        void return_value(TaskResult value)
+        {
+            result = std::move(value);
+        }
+
+        void unhandled_exception() const
+        {
+            std::terminate();
+        }
+    };
+
+    task_t(task_t&& other);
+
+    task_t(const task_t& other) = delete;
+
+    // destroys the coroutine if it was never spawned.
+    ~task_t();
+
+private:
+    friend class task_scheduler_t;
+
+    explicit task_t(handle_t handle);
+
+private:
+    handle_t m_handle;
+};
+
+enum class task_wait_kind_t : uint8_t {
+    next_frame,
+    next_fixed_step,
+    worker_thread,
+    main_thread,
+    condition,
+};
+
+// polled once per frame on the main thread.
+using task_condition_t = std::function<bool(registry_t)>;
+
+class task_wait_t {
+public:
+    task_wait_t(task_wait_kind_t kind, task_condition_t condition = {});
+
+    bool await_ready() const;
+
+    void await_suspend(task_t::handle_t handle);
+
+    void await_resume() const { }
+
+private:
+    task_wait_kind_t m_kind;
+    task_condition_t m_condition;
+};
+
+// resumes after the update systems of the next frame.
+task_wait_t next_frame();
+
+// resumes after the fixed update systems of the next fixed step.
+task_wait_t next_fixed_step();
+
+// continues on a worker thread. code running there must not touch the
+// registry or gl, only data the task owns and the command buffers.
+task_wait_t worker_thread();
+
+// continues on the main thread at the end of the current or next frame.
+task_wait_t main_thread();
+
+// resumes at the end of the first frame where `condition` holds, e.g. once
+// a gpu fence is signaled.
+task_wait_t wait_until(task_condition_t condition);
+
+// runs tasks for the app. tasks resume on the main thread after the update
+// systems of a frame, or after the fixed update systems for
+// `next_fixed_step`. worker threads are only started once a task asks for
+// one. available as the `task_scheduler_t*` resource.
+class task_scheduler_t {
+public:
+    task_scheduler_t() = default;
+
+    task_scheduler_t(const task_scheduler_t& other) = delete;
+    task_scheduler_t& operator=(const task_scheduler_t& other) = delete;
+
+    ~task_scheduler_t();
+
+    // runs `task` on the calling thread until its first wait.
+    void spawn(task_t task);
+
+    // called before any system of a frame or a fixed step runs. only tasks
+    // that waited before then are resumed at its end, a task waiting during
+    // the frame waits for the next one.
+    void begin_frame();
+
+    void begin_fixed_step();
+
+    // resumes the tasks waiting for the frame, the main thread or a
+    // condition. returns the error of a task that failed since the last call.
+    TaskResult resume_frame(registry_t rg);
+
+    TaskResult resume_fixed_step();
+
+    // joins the workers and destroys every unfinished task.
+    void stop();
+
+    size_t get_task_count();
+
+    static bool is_worker_thread();
+
+private:
+    friend struct task_t::final_awaiter_t;
+    friend class task_wait_t;
+
+    struct waiting_t {
+        task_condition_t condition;
+        task_t::handle_t handle;
+    };
+
+    void wait(task_t::handle_t handle,
+              task_wait_kind_t kind,
+              task_condition_t condition);
+
+    void finish(task_t::handle_t handle);
+
+    void run_worker();
+
+    TaskResult take_error();
+
+private:
+    // swapped with the lists below while resuming, only used on the main
+    // thread.
+    std::vector<task_t::handle_t> m_resuming;
+    std::vector<waiting_t> m_polling;
+
+    // the waits of `m_next_frame` and `m_next_fixed_step` taken at the start
+    // of the frame or fixed step, only used on the main thread.
+    std::vector<task_t::handle_t> m_frame_due;
+    std::vector<task_t::handle_t> m_fixed_step_due;
+
+    // guards everything below, tasks can wait from any thread.
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+
+    std::vector<task_t::handle_t> m_next_frame;
+    std::vector<task_t::handle_t> m_next_fixed_step;
+    std::vector<task_t::handle_t> m_main_thread;
+    std::vector<waiting_t> m_waiting;
+
+    std::deque<task_t::handle_t> m_worker_queue;
+    std::vector<std::thread> m_workers;
+
+    std::unordered_set<void*> m_tasks;
+    std::vector<std::string> m_errors;
+
+    bool m_stopping { false };
+};
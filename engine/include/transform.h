@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <app.h>
+#include <fecs.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// local transform, relative to the parent if the entity has one. changes are
+// only picked up when they go through the registry (`patch`, `replace`,
+// `emplace_or_replace`), writes through a view don't mark it dirty.
+struct transform_t {
+    glm::vec3 position { 0.0f };
+    glm::quat rotation { 1.0f, 0.0f, 0.0f, 0.0f };
+    glm::vec3 scale { 1.0f };
+};
+
+struct parent_t {
+    entt::entity entity { entt::null };
+};
+
+// computed by the transform plugin for every entity with a `transform_t`.
+struct world_transform_t {
+    glm::mat4 matrix { 1.0f };
+};
+
+// flattened hierarchy, available as a resource. the storages of
+// `transform_t` and `world_transform_t` are kept sorted by depth, so index
+// `i` of either storage is node `i` and parents always come before their
+// children.
+struct transform_hierarchy_t {
+    static constexpr uint32_t NO_PARENT = UINT32_MAX;
+
+    std::vector<uint32_t> parents;
+    std::vector<uint8_t> dirty;
+
+    // set when nodes are added, removed or reparented, the order is rebuilt
+    // and every node recomputed on the next update.
+    bool structure_dirty { true };
+
+    // depth of every entity by entity index, only used while rebuilding.
+    std::vector<uint32_t> depths;
+};
+
+// keeps `world_transform_t` up to date in an update system. only nodes whose
+// transform changed and their descendants are recomputed. the transform
+// storages are sorted, so they can't be owned by a group.
+class transform_plugin_t : public plugin_t {
+public:
+    virtual ~transform_plugin_t() override = default;
+
+    virtual PluginResult build(app_t* app) override;
+
+    static SystemResult update(registry_t rg);
+};
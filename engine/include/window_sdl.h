@@ -9,6 +9,7 @@
 
 #include "app.h"
 #include "fecs.h"
+#include "input.h"
 
 struct sdl_context_t {
     SDL_Window* window;
@@ -19,15 +20,32 @@ struct window_creation_info_t {
     const char* title;
     int32_t width;
     int32_t height;
+
+    // uses sdl's offscreen video driver and a hidden window, so rendering
+    // works without a display.
+    bool headless { false };
+
+    // the input resources are filled by something else, e.g. a replay. sdl
+    // events are still drained but neither they nor the devices reach the
+    // input resources.
+    bool external_input { false };
 };
 
+// owns the window and the only calls to the sdl event loop. events are
+// pumped into the `input_events_t` and `input_state_t` resources at the
+// start of every frame, systems read those instead of sdl.
 class window_sdl_t : public plugin_t {
 
 public:
+    // with `late_input_sampling` the keyboard and mouse state is sampled
+    // again right before the renderer builds its view. events still arrive
+    // at the frame start.
     window_sdl_t(const char* title,
                  int32_t width,
                  int32_t height,
-                 UpdateSystem event_handler);
+                 bool late_input_sampling = false);
+
+    window_sdl_t(window_creation_info_t info, bool late_input_sampling = false);
 
     window_sdl_t(window_sdl_t&& other);
 
@@ -39,11 +57,21 @@ public:
 
     window_creation_info_t get_creation_info() const;
 
+    // called by renderers before their draw systems.
+    void add_late_input_sampling(app_t* app) const;
+
     static SystemResult setup(registry_t rg);
 
+    static SystemResult
+    pump_events(resource_t<const window_creation_info_t> info,
+                resource_t<input_events_t> events,
+                resource_t<input_state_t> state);
+
+    static SystemResult sample_input(resource_t<input_state_t> state);
+
     static SystemResult shutdown(registry_t rg);
 
 private:
     window_creation_info_t m_info;
-    UpdateSystem m_event_handler;
+    bool m_late_input_sampling;
 };
\ No newline at end of file
@@ -1,7 +1,192 @@
+#include <algorithm>
 #include <chrono>
+#include <unordered_map>
 
 #include <app.h>
 
+template<typename T, typename... Args>
+static SystemResult run_system(const scheduled_system_t<T>& scheduled,
+                               timing_t* timing,
+                               Args... args)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    auto previous = memory_tracker_t::set_scope(scheduled.memory_scope);
+    auto result = scheduled.system(args...);
+    memory_tracker_t::set_scope(previous);
+
+    registry_t::advance_change_tick();
+
+    if (timing) {
+        timing->cpu_ms += std::chrono::duration<float, std::milli>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+    }
+
+    return result;
+}
+
+template<typename T>
+static scheduled_system_t<T>
+make_scheduled(T system, std::string_view stage, size_t index)
+{
+    auto name = system.get_name().empty()
+        ? std::format("{} system #{}", stage, index)
+        : std::string(system.get_name());
+    auto scope = memory_tracker_t::register_scope(name);
+
+    return { std::move(system), std::move(name), scope };
+}
+
+// checks the run conditions and rate of `system`. returns the `dt` to run it
+// with, nothing if it's skipped this time.
+template<typename T>
+static std::optional<float> should_run(scheduled_system_t<T>* system,
+                                       const std::vector<system_set_t>& sets,
+                                       registry_t rg,
+                                       float dt)
+{
+    const auto& options = system->options;
+
+    if ((system->set != scheduled_system_t<T>::NO_SET
+         && !sets[system->set].active)
+        || (options.run_if && !options.run_if(rg))) {
+        system->elapsed = 0.0f;
+        return {};
+    }
+
+    system->elapsed += dt;
+
+    if (options.rate_hz > 0.0f) {
+        auto period = 1.0f / options.rate_hz;
+
+        system->phase += dt;
+        if (system->phase < period)
+            return {};
+
+        // after a long frame the system runs once, missed runs are dropped.
+        system->phase = std::min(system->phase - period, period);
+    } else if (++system->frames < options.every_frames) {
+        return {};
+    } else {
+        system->frames = 0;
+    }
+
+    return std::exchange(system->elapsed, 0.0f);
+}
+
+// runs `system` if it is due, on its next slice of entities if it has
+// slices.
+template<typename T>
+static SystemResult dispatch_system(scheduled_system_t<T>* system,
+                                    const std::vector<system_set_t>& sets,
+                                    timing_t* timing,
+                                    entt::registry* rg,
+                                    float dt)
+{
+    auto system_dt = should_run(system, sets, rg, dt);
+    if (!system_dt)
+        return {};
+
+    auto slices = system->options.slices;
+    if (slices <= 1)
+        return run_system(*system, timing, rg, *system_dt);
+
+    auto& slice = rg->ctx().get<system_slice_t>();
+    slice = { .index = system->slice, .count = slices };
+    system->slice = (system->slice + 1) % slices;
+
+    auto result = run_system(*system, timing, rg, *system_dt);
+    slice = {};
+
+    return result;
+}
+
+// stable topological sort, systems keep the order they were added in unless
+// their sets say otherwise.
+template<typename T>
+static std::expected<void, std::string>
+sort_stage(std::vector<scheduled_system_t<T>>* systems,
+           const std::vector<uint8_t>& precedes,
+           size_t set_count)
+{
+    constexpr auto NO_SET = scheduled_system_t<T>::NO_SET;
+
+    auto count = systems->size();
+
+    auto is_before = [&](size_t a, size_t b) {
+        auto first = (*systems)[a].set;
+        auto second = (*systems)[b].set;
+
+        return first != NO_SET && second != NO_SET
+            && precedes[first * set_count + second];
+    };
+
+    std::vector<uint32_t> waiting(count, 0);
+    for (size_t a = 0; a < count; a++) {
+        for (size_t b = 0; b < count; b++)
+            waiting[b] += is_before(a, b);
+    }
+
+    std::vector<size_t> order;
+    std::vector<uint8_t> placed(count, 0);
+
+    while (order.size() < count) {
+        // the earliest added system that has nothing left to wait for.
+        size_t next = 0;
+        while (next < count && (placed[next] || waiting[next]))
+            next++;
+
+        if (next == count) {
+            return std::unexpected(std::format(
+                "the sets of '{}' are ordered in a cycle",
+                (*systems)[std::ranges::find(placed, 0) - placed.begin()]
+                    .name));
+        }
+
+        placed[next] = 1;
+        order.push_back(next);
+
+        for (size_t b = 0; b < count; b++) {
+            if (!placed[b] && is_before(next, b))
+                waiting[b]--;
+        }
+    }
+
+    std::vector<scheduled_system_t<T>> sorted;
+    sorted.reserve(count);
+
+    for (auto index : order)
+        sorted.push_back(std::move((*systems)[index]));
+
+    // systems that run every n frames are spread over those frames.
+    std::unordered_map<uint32_t, uint32_t> intervals;
+    for (auto& system : sorted) {
+        auto every = std::max(system.options.every_frames, 1u);
+        system.frames = intervals[every]++ % every;
+    }
+
+    *systems = std::move(sorted);
+    return {};
+}
+
+static void print_memory_report(const memory_stats_t& stats)
+{
+    std::println(stderr, "memory high-water marks:");
+
+    for (const auto& usage : stats.scopes) {
+        if (!usage.total_allocations)
+            continue;
+
+        std::println(stderr,
+                     "  {:<40} peak {:>12} B, live {:>12} B, {} allocations",
+                     usage.name,
+                     usage.peak_bytes,
+                     usage.live_bytes,
+                     usage.total_allocations);
+    }
+}
+
 void app_t::run()
 {
     if (!m_app_state.can_run)
@@ -12,21 +197,43 @@ void app_t::run()
                            std::chrono::high_resolution_clock,
                            std::chrono::steady_clock>::type;
 
-    m_rg.ctx().emplace<app_state_t*>(&m_app_state);
+    auto rg = get_registry();
+    rg.put_resource<app_state_t*>(&m_app_state);
+    rg.put_resource<frame_arena_pool_t*>(&m_frame_arenas);
+    rg.put_resource<command_buffer_pool_t*>(&m_commands);
+    rg.put_resource<memory_stats_t*>(&m_memory_stats);
+    rg.put_resource<frame_timings_t*>(&m_timings);
+    rg.put_resource<task_scheduler_t*>(&m_tasks);
+    rg.put_resource<system_slice_t>();
+
+    if (auto result = sort_systems(); !result) {
+        std::println(stderr, "ERROR: {}", result.error());
+        return;
+    }
+
+    m_timings.systems.clear();
+    for (const auto& system : m_fixed_update_systems)
+        m_timings.systems.push_back({ .name = system.name });
+    for (const auto& system : m_update_systems)
+        m_timings.systems.push_back({ .name = system.name });
 
     for (const auto& system : m_startup_systems) {
-        if (auto result = system(&m_rg); !result) {
+        if (auto result = run_system(system, nullptr, &m_rg); !result) {
             std::println(stderr, "ERROR: {}", result.error());
             return;
         }
     }
 
+    m_commands.apply(&m_rg);
+
     float time_acc { 0.0f };
 
     auto last_time = clock::now();
 
     m_app_state.running = true;
     while (m_app_state.running) {
+        m_frame_arenas.reset();
+
         auto current_time = clock::now();
         auto delta_time
             = std::chrono::duration<float, std::chrono::seconds::period>(
@@ -35,36 +242,93 @@ void app_t::run()
 
         last_time = current_time;
 
+        // frame timings always measure the wall clock.
+        m_timings.frame_ms = delta_time * 1000.0f;
+
+        if (m_frame_clock) {
+            auto next = m_frame_clock();
+            if (!next) {
+                m_app_state.running = false;
+                break;
+            }
+
+            delta_time = *next;
+        }
+
+        for (auto& timing : m_timings.systems)
+            timing.cpu_ms = 0.0f;
+
+        for (auto& set : m_sets)
+            set.active = !set.options.run_if || set.options.run_if(rg);
+
+        m_tasks.begin_frame();
+
         time_acc += delta_time;
         while (time_acc >= m_app_state.fixed_time_step) {
-            for (const auto& system : m_fixed_update_systems) {
-                if (auto result = system(&m_rg, m_app_state.fixed_time_step);
+            auto timing = m_timings.systems.data();
+
+            m_tasks.begin_fixed_step();
+
+            for (auto& system : m_fixed_update_systems) {
+                if (auto result = dispatch_system(&system,
+                                                  m_sets,
+                                                  timing++,
+                                                  &m_rg,
+                                                  m_app_state.fixed_time_step);
                     !result) {
                     std::println(stderr, "ERROR: {}", result.error());
                     m_app_state.running = false;
                     goto end;
                 }
             }
+
+            if (auto result = m_tasks.resume_fixed_step(); !result) {
+                std::println(stderr, "ERROR: {}", result.error());
+                m_app_state.running = false;
+                goto end;
+            }
+
+            m_commands.apply(&m_rg);
             time_acc -= m_app_state.fixed_time_step;
         }
 
-        for (const auto& system : m_update_systems) {
-            if (auto result = system(&m_rg, delta_time); !result) {
+        auto timing = m_timings.systems.data() + m_fixed_update_systems.size();
+
+        for (auto& system : m_update_systems) {
+            if (auto result = dispatch_system(
+                    &system, m_sets, timing++, &m_rg, delta_time);
+                !result) {
                 std::println(stderr, "ERROR: {}", result.error());
                 m_app_state.running = false;
                 goto end;
             }
         }
+
+        if (auto result = m_tasks.resume_frame(rg); !result) {
+            std::println(stderr, "ERROR: {}", result.error());
+            m_app_state.running = false;
+            goto end;
+        }
+
+        m_commands.apply(&m_rg);
+        memory_tracker_t::collect(&m_memory_stats);
     }
 
 end:
+    // tasks may hold assets and gl objects that shutdown systems release.
+    m_tasks.stop();
 
     for (const auto& system : m_shutdown_systems) {
-        if (auto result = system(&m_rg); !result) {
+        if (auto result = run_system(system, nullptr, &m_rg); !result) {
             std::println(stderr, "ERROR: {}", result.error());
             return;
         }
     }
+
+    if (memory_tracker_t::is_heap_tracking_enabled()) {
+        memory_tracker_t::collect(&m_memory_stats);
+        print_memory_report(m_memory_stats);
+    }
 }
 
 void app_t::add_plugin(std::unique_ptr<plugin_t> plugin)
@@ -77,25 +341,117 @@ void app_t::add_plugin(std::unique_ptr<plugin_t> plugin)
 
 void app_t::add_system(startup_system_t system)
 {
-    m_startup_systems.push_back(std::move(system));
+    m_startup_systems.push_back(
+        make_scheduled(std::move(system), "startup", m_startup_systems.size()));
 }
 
 void app_t::add_system(shutdown_system_t system)
 {
-    m_shutdown_systems.push_back(std::move(system));
+    m_shutdown_systems.push_back(make_scheduled(
+        std::move(system), "shutdown", m_shutdown_systems.size()));
+}
+
+void app_t::add_system(fixed_update_system_t system,
+                       system_options_t options)
+{
+    auto& scheduled = m_fixed_update_systems.emplace_back(make_scheduled(
+        std::move(system), "fixed update", m_fixed_update_systems.size()));
+
+    if (!options.set.empty())
+        scheduled.set = get_set(options.set);
+
+    scheduled.options = std::move(options);
 }
 
-void app_t::add_system(fixed_update_system_t system)
+void app_t::add_system(update_system_t system, system_options_t options)
 {
-    m_fixed_update_systems.push_back(std::move(system));
+    auto& scheduled = m_update_systems.emplace_back(
+        make_scheduled(std::move(system), "update", m_update_systems.size()));
+
+    if (!options.set.empty())
+        scheduled.set = get_set(options.set);
+
+    scheduled.options = std::move(options);
 }
 
-void app_t::add_system(update_system_t system)
+void app_t::configure_set(std::string_view name, system_set_options_t options)
 {
-    m_update_systems.push_back(std::move(system));
+    auto index = get_set(name);
+
+    // every referenced set exists before the systems are sorted.
+    for (const auto& other : options.after)
+        get_set(other);
+    for (const auto& other : options.before)
+        get_set(other);
+
+    m_sets[index].options = std::move(options);
+}
+
+void app_t::set_frame_clock(frame_clock_t clock)
+{
+    m_frame_clock = std::move(clock);
 }
 
 registry_t app_t::get_registry()
 {
     return { &m_rg };
 }
+
+uint32_t app_t::get_set(std::string_view name)
+{
+    auto it = std::ranges::find(m_sets, name, &system_set_t::name);
+    if (it != m_sets.end())
+        return static_cast<uint32_t>(it - m_sets.begin());
+
+    m_sets.push_back({ .name = std::string(name) });
+    return static_cast<uint32_t>(m_sets.size() - 1);
+}
+
+std::expected<void, std::string> app_t::sort_systems()
+{
+    // sets that are only named in `before` or `after` are added first, so
+    // the count doesn't change below.
+    for (size_t i = 0; i < m_sets.size(); i++) {
+        for (const auto& name : m_sets[i].options.after)
+            get_set(name);
+        for (const auto& name : m_sets[i].options.before)
+            get_set(name);
+    }
+
+    auto count = m_sets.size();
+
+    // `precedes[a * count + b]` is set if set `a` runs before set `b`.
+    std::vector<uint8_t> precedes(count * count, 0);
+    for (size_t i = 0; i < count; i++) {
+        for (const auto& name : m_sets[i].options.after)
+            precedes[get_set(name) * count + i] = 1;
+        for (const auto& name : m_sets[i].options.before)
+            precedes[i * count + get_set(name)] = 1;
+    }
+
+    // orders are transitive, a set in between orders the sets around it even
+    // if none of its systems run in a stage.
+    for (size_t k = 0; k < count; k++) {
+        for (size_t i = 0; i < count; i++) {
+            if (!precedes[i * count + k])
+                continue;
+
+            for (size_t j = 0; j < count; j++)
+                precedes[i * count + j] |= precedes[k * count + j];
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (precedes[i * count + i]) {
+            return std::unexpected(std::format(
+                "the set '{}' is ordered in a cycle", m_sets[i].name));
+        }
+    }
+
+    if (auto result = sort_stage(&m_fixed_update_systems, precedes, count);
+        !result) {
+        return result;
+    }
+
+    return sort_stage(&m_update_systems, precedes, count);
+}
@@ -0,0 +1,354 @@
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <print>
+
+#include <asset_manager.h>
+#include <memory_stats.h>
+
+// paths are normalized so different spellings of the same file share an
+// asset.
+static std::string make_key(const fs::path& path)
+{
+    std::error_code error;
+    auto canonical = fs::weakly_canonical(path, error);
+
+    return error ? path.lexically_normal().string() : canonical.string();
+}
+
+static size_t get_model_size(const model_t& model)
+{
+    size_t size = 0;
+    for (const auto& mesh : model.meshes) {
+        size += sizeof(vertex_t) * mesh.vertices.size()
+            + sizeof(uint32_t) * mesh.indices.size();
+    }
+
+    return size;
+}
+
+asset_manager_t::asset_manager_t(asset_budget_t budget)
+    : m_budget(budget)
+{
+}
+
+std::expected<model_handle_t, std::string>
+asset_manager_t::load_model(const fs::path& path)
+{
+    auto key = make_key(path);
+    if (auto handle = find<model_t>(key))
+        return *handle;
+
+    std::vector<texture_handle_t> textures;
+
+    auto model = ::load_model(path, [this, &textures](const fs::path& path) {
+        auto handle = load_texture(path);
+        if (!handle) {
+            std::println(stderr, "WARNING: {}", handle.error());
+            return 0u;
+        }
+
+        textures.push_back(*handle);
+        return get(*handle)->id;
+    });
+
+    if (!model) {
+        for (auto texture : textures)
+            release(texture);
+
+        return std::unexpected(
+            std::format("can't load model '{}'", path.string()));
+    }
+
+    auto size = get_model_size(*model);
+    auto handle = insert(std::move(key), std::move(*model), size, size);
+
+    m_model_textures[handle.index] = std::move(textures);
+
+    evict();
+    return handle;
+}
+
+std::expected<texture_handle_t, std::string>
+asset_manager_t::load_texture(const fs::path& path)
+{
+    auto key = make_key(path);
+    if (auto handle = find<texture_t>(key))
+        return *handle;
+
+    auto cooked = cook_texture_cached(path);
+    if (!cooked)
+        return std::unexpected(cooked.error());
+
+    auto texture = m_streamer.load(*cooked);
+    if (!texture)
+        return std::unexpected(texture.error());
+
+    auto handle = insert(std::move(key), *texture, 0, texture->size);
+
+    evict();
+    return handle;
+}
+
+std::expected<shader_handle_t, std::string>
+asset_manager_t::load_shader(const fs::path& path)
+{
+    auto key = make_key(path);
+    if (auto handle = find<shader_t>(key))
+        return *handle;
+
+    shader_t shader;
+    if (auto result = shader.load_shader(path); !result)
+        return std::unexpected(result.error());
+
+    auto handle = insert(std::move(key), std::move(shader), 0, 0);
+
+    evict();
+    return handle;
+}
+
+bool asset_manager_t::is_ready(model_handle_t handle)
+{
+    if (!m_models.get_slot(handle))
+        return true;
+
+    auto it = m_model_textures.find(handle.index);
+    if (it == m_model_textures.end())
+        return true;
+
+    return std::ranges::all_of(it->second, [this](texture_handle_t texture) {
+        return is_ready(texture);
+    });
+}
+
+bool asset_manager_t::is_ready(texture_handle_t handle)
+{
+    auto slot = m_textures.get_slot(handle);
+    return !slot || !m_streamer.is_streaming(slot->asset->id);
+}
+
+bool asset_manager_t::is_ready(shader_handle_t)
+{
+    return true;
+}
+
+void asset_manager_t::set_budget(asset_budget_t budget)
+{
+    m_budget = budget;
+    evict();
+}
+
+asset_budget_t asset_manager_t::get_budget() const
+{
+    return m_budget;
+}
+
+asset_usage_t asset_manager_t::get_usage() const
+{
+    auto usage = m_usage;
+    usage.unreferenced = 0;
+
+    auto count = [&usage](const auto& pool) {
+        for (const auto& slot : pool.slots) {
+            if (slot.asset && slot.ref_count == 0)
+                usage.unreferenced++;
+        }
+    };
+
+    count(m_models);
+    count(m_textures);
+    count(m_shaders);
+
+    return usage;
+}
+
+void asset_manager_t::update()
+{
+    m_tick++;
+
+    if (!m_streamer.is_idle())
+        m_streamer.update(m_budget.upload_bytes);
+
+    evict();
+}
+
+void asset_manager_t::evict()
+{
+    while (is_over_budget()) {
+        // least recently used unreferenced asset across every pool.
+        uint64_t oldest = UINT64_MAX;
+        void (asset_manager_t::*unload_oldest)(uint32_t) = nullptr;
+        uint32_t oldest_index = 0;
+
+        auto visit = [&]<typename T>(const pool_t<T>& pool) {
+            for (uint32_t i = 0; i < pool.slots.size(); i++) {
+                const auto& slot = pool.slots[i];
+                if (!slot.asset || slot.ref_count > 0
+                    || slot.last_used >= oldest) {
+                    continue;
+                }
+
+                oldest = slot.last_used;
+                oldest_index = i;
+                unload_oldest = &asset_manager_t::unload<T>;
+            }
+        };
+
+        visit(m_models);
+        visit(m_textures);
+        visit(m_shaders);
+
+        if (!unload_oldest)
+            break;
+
+        (this->*unload_oldest)(oldest_index);
+    }
+}
+
+void asset_manager_t::clear()
+{
+    // models first, they hold references to textures.
+    auto unload_all = [this]<typename T>(pool_t<T>& pool) {
+        for (uint32_t i = 0; i < pool.slots.size(); i++) {
+            if (pool.slots[i].asset)
+                unload<T>(i);
+        }
+    };
+
+    unload_all(m_models);
+    unload_all(m_textures);
+    unload_all(m_shaders);
+}
+
+template<typename T>
+std::optional<asset_handle_t<T>>
+asset_manager_t::find(const std::string& key)
+{
+    auto pool = get_pool<T>();
+
+    auto it = pool->lookup.find(key);
+    if (it == pool->lookup.end())
+        return std::nullopt;
+
+    auto& slot = pool->slots[it->second];
+    slot.ref_count++;
+    slot.last_used = m_tick;
+
+    return asset_handle_t<T> { it->second, slot.generation };
+}
+
+template<typename T>
+asset_handle_t<T> asset_manager_t::insert(std::string key,
+                                          T asset,
+                                          size_t cpu_bytes,
+                                          size_t gpu_bytes)
+{
+    auto pool = get_pool<T>();
+
+    uint32_t index;
+    if (!pool->free_slots.empty()) {
+        index = pool->free_slots.back();
+        pool->free_slots.pop_back();
+    } else {
+        index = pool->slots.size();
+        pool->slots.emplace_back();
+    }
+
+    auto& slot = pool->slots[index];
+    slot.asset.emplace(std::move(asset));
+    slot.key = key;
+    slot.ref_count = 1;
+    slot.cpu_bytes = cpu_bytes;
+    slot.gpu_bytes = gpu_bytes;
+    slot.last_used = m_tick;
+
+    pool->lookup.emplace(std::move(key), index);
+
+    m_usage.cpu_bytes += cpu_bytes;
+    m_usage.gpu_bytes += gpu_bytes;
+    m_usage.loaded++;
+
+    return { index, slot.generation };
+}
+
+template<typename T>
+void asset_manager_t::unload(uint32_t index)
+{
+    auto pool = get_pool<T>();
+    auto& slot = pool->slots[index];
+
+    destroy(index, &*slot.asset);
+    slot.asset.reset();
+
+    pool->lookup.erase(slot.key);
+    slot.key.clear();
+
+    // invalidates every handle still pointing at this slot.
+    slot.generation++;
+    slot.ref_count = 0;
+
+    m_usage.cpu_bytes -= slot.cpu_bytes;
+    m_usage.gpu_bytes -= slot.gpu_bytes;
+    m_usage.loaded--;
+
+    pool->free_slots.push_back(index);
+}
+
+void asset_manager_t::destroy(uint32_t index, model_t* model)
+{
+    unload_model(model);
+
+    if (auto it = m_model_textures.find(index); it != m_model_textures.end()) {
+        for (auto texture : it->second)
+            release(texture);
+
+        m_model_textures.erase(it);
+    }
+}
+
+void asset_manager_t::destroy(uint32_t, texture_t* texture)
+{
+    m_streamer.cancel(texture->id);
+    glDeleteTextures(1, &texture->id);
+
+    memory_tracker_t::track_gpu(memory_tracker_t::GPU_TEXTURE_SCOPE,
+                                -static_cast<int64_t>(texture->size));
+}
+
+void asset_manager_t::destroy(uint32_t, shader_t*)
+{
+}
+
+bool asset_manager_t::is_over_budget() const
+{
+    return m_usage.cpu_bytes > m_budget.cpu_bytes
+        || m_usage.gpu_bytes > m_budget.gpu_bytes;
+}
+
+asset_plugin_t::asset_plugin_t(asset_budget_t budget)
+    : m_budget(budget)
+{
+}
+
+PluginResult asset_plugin_t::build(app_t* app)
+{
+    auto rg = app->get_registry();
+    rg.put_resource<asset_manager_t>(m_budget);
+
+    app->add_system(make_update<update>());
+    app->add_system(make_shutdown<shutdown>());
+
+    return {};
+}
+
+SystemResult asset_plugin_t::update(resource_t<asset_manager_t> assets)
+{
+    assets->update();
+    return {};
+}
+
+SystemResult asset_plugin_t::shutdown(resource_t<asset_manager_t> assets)
+{
+    assets->clear();
+    return {};
+}
@@ -0,0 +1,51 @@
+#include <command_buffer.h>
+
+command_buffer_t::~command_buffer_t()
+{
+    clear();
+}
+
+void command_buffer_t::destroy_entity(entt::entity entity)
+{
+    push<entt::entity>(
+        [](entt::registry* rg, entt::entity* entity) {
+            if (rg->valid(*entity))
+                rg->destroy(*entity);
+        },
+        entity);
+}
+
+void command_buffer_t::apply(entt::registry* rg)
+{
+    for (const auto& command : m_commands)
+        command.apply(rg, command.payload);
+
+    clear();
+}
+
+bool command_buffer_t::empty() const
+{
+    return m_commands.empty();
+}
+
+void command_buffer_t::clear()
+{
+    for (const auto& command : m_commands)
+        command.destroy(command.payload);
+
+    m_commands.clear();
+    m_storage.reset();
+}
+
+command_buffer_t* command_buffer_pool_t::get_buffer()
+{
+    return m_buffers.local();
+}
+
+void command_buffer_pool_t::apply(entt::registry* rg)
+{
+    m_buffers.for_each([rg](command_buffer_t& buffer) {
+        if (!buffer.empty())
+            buffer.apply(rg);
+    });
+}
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <new>
+
+#include <frame_arena.h>
+
+static constexpr std::align_val_t BLOCK_ALIGNMENT {
+    alignof(std::max_align_t)
+};
+
+frame_arena_t::frame_arena_t(size_t block_size)
+    : m_block_size(block_size)
+{
+}
+
+frame_arena_t::~frame_arena_t()
+{
+    release_blocks();
+}
+
+void frame_arena_t::reset()
+{
+    // if the last frame spilled into more than one block, replace them with a
+    // single block big enough to hold everything so the next frame stays on
+    // the fast path.
+    if (m_blocks.size() > 1) {
+        auto capacity = get_capacity();
+
+        release_blocks();
+        allocate_block(capacity);
+    }
+
+    m_current_block = 0;
+    m_offset = 0;
+    m_used = 0;
+}
+
+size_t frame_arena_t::get_used_bytes() const
+{
+    return m_used;
+}
+
+size_t frame_arena_t::get_capacity() const
+{
+    size_t capacity = 0;
+    for (const auto& block : m_blocks)
+        capacity += block.size;
+
+    return capacity;
+}
+
+void* frame_arena_t::do_allocate(size_t bytes, size_t alignment)
+{
+    while (m_current_block < m_blocks.size()) {
+        auto& block = m_blocks[m_current_block];
+
+        auto address = reinterpret_cast<uintptr_t>(block.data) + m_offset;
+        auto aligned = (address + alignment - 1) & ~(alignment - 1);
+        auto padding = aligned - address;
+
+        if (m_offset + padding + bytes <= block.size) {
+            m_offset += padding + bytes;
+            m_used += bytes;
+            return reinterpret_cast<void*>(aligned);
+        }
+
+        m_current_block++;
+        m_offset = 0;
+    }
+
+    auto size = std::max(m_block_size, bytes + alignment);
+    auto data = allocate_block(size);
+
+    m_current_block = m_blocks.size() - 1;
+
+    auto address = reinterpret_cast<uintptr_t>(data);
+    auto aligned = (address + alignment - 1) & ~(alignment - 1);
+
+    m_offset = (aligned - address) + bytes;
+    m_used += bytes;
+
+    return reinterpret_cast<void*>(aligned);
+}
+
+void frame_arena_t::do_deallocate(void*, size_t, size_t)
+{
+}
+
+bool frame_arena_t::do_is_equal(
+    const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+std::byte* frame_arena_t::allocate_block(size_t size)
+{
+    auto data = static_cast<std::byte*>(::operator new(size, BLOCK_ALIGNMENT));
+    m_blocks.push_back({ .data = data, .size = size });
+
+    return data;
+}
+
+void frame_arena_t::release_blocks()
+{
+    for (const auto& block : m_blocks)
+        ::operator delete(block.data, BLOCK_ALIGNMENT);
+
+    m_blocks.clear();
+}
+
+frame_arena_t* frame_arena_pool_t::get_arena()
+{
+    return m_arenas.local();
+}
+
+void frame_arena_pool_t::reset()
+{
+    m_arenas.for_each([](frame_arena_t& arena) { arena.reset(); });
+}
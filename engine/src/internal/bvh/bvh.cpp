@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#ifdef __SSE__
+    #include <xmmintrin.h>
+#endif
+
+#include "bvh.h"
+
+static constexpr uint32_t MAX_LEAF_SIZE = 4;
+static constexpr uint32_t PLANE_COUNT = 6;
+
+enum class containment_t : uint8_t {
+    outside,
+    intersecting,
+    inside,
+};
+
+static aabb_t merge(const aabb_t& a, const aabb_t& b)
+{
+    return { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+}
+
+static float get_area(const aabb_t& aabb)
+{
+    auto size = aabb.max - aabb.min;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+aabb_t transform_aabb(const aabb_t& local, const glm::mat4& matrix)
+{
+    auto center = (local.min + local.max) * 0.5f;
+    auto extent = (local.max - local.min) * 0.5f;
+
+    auto world_center = glm::vec3(matrix * glm::vec4(center, 1.0f));
+    auto world_extent = glm::abs(glm::vec3(matrix[0])) * extent.x
+        + glm::abs(glm::vec3(matrix[1])) * extent.y
+        + glm::abs(glm::vec3(matrix[2])) * extent.z;
+
+    return { world_center - world_extent, world_center + world_extent };
+}
+
+frustum_t make_frustum(const glm::mat4& view_projection)
+{
+    auto row = [&view_projection](int32_t i) {
+        return glm::vec4(view_projection[0][i],
+                         view_projection[1][i],
+                         view_projection[2][i],
+                         view_projection[3][i]);
+    };
+
+    // left, right, bottom, top, near, far. the planes aren't normalized,
+    // only the sign of the distances is used.
+    glm::vec4 planes[PLANE_COUNT] = {
+        row(3) + row(0), row(3) - row(0), row(3) + row(1),
+        row(3) - row(1), row(3) + row(2), row(3) - row(2),
+    };
+
+    frustum_t frustum;
+    for (uint32_t i = 0; i < 8; i++) {
+        auto plane = i < PLANE_COUNT ? planes[i]
+                                     : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+        frustum.x[i] = plane.x;
+        frustum.y[i] = plane.y;
+        frustum.z[i] = plane.z;
+        frustum.w[i] = plane.w;
+    }
+
+    return frustum;
+}
+
+static containment_t classify(const frustum_t& frustum, const aabb_t& aabb)
+{
+    auto center = (aabb.min + aabb.max) * 0.5f;
+    auto extent = (aabb.max - aabb.min) * 0.5f;
+
+#ifdef __SSE__
+    auto cx = _mm_set1_ps(center.x);
+    auto cy = _mm_set1_ps(center.y);
+    auto cz = _mm_set1_ps(center.z);
+    auto ex = _mm_set1_ps(extent.x);
+    auto ey = _mm_set1_ps(extent.y);
+    auto ez = _mm_set1_ps(extent.z);
+
+    auto sign = _mm_set1_ps(-0.0f);
+
+    int32_t outside = 0;
+    int32_t intersecting = 0;
+
+    for (uint32_t i = 0; i < 8; i += 4) {
+        auto px = _mm_load_ps(frustum.x + i);
+        auto py = _mm_load_ps(frustum.y + i);
+        auto pz = _mm_load_ps(frustum.z + i);
+
+        // signed distance of the center and the projected radius.
+        auto distance = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(px, cx), _mm_mul_ps(py, cy)),
+            _mm_add_ps(_mm_mul_ps(pz, cz), _mm_load_ps(frustum.w + i)));
+        auto radius = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(_mm_andnot_ps(sign, px), ex),
+                       _mm_mul_ps(_mm_andnot_ps(sign, py), ey)),
+            _mm_mul_ps(_mm_andnot_ps(sign, pz), ez));
+
+        outside |= _mm_movemask_ps(
+            _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        intersecting |= _mm_movemask_ps(
+            _mm_cmplt_ps(_mm_sub_ps(distance, radius), _mm_setzero_ps()));
+    }
+
+    if (outside)
+        return containment_t::outside;
+
+    return intersecting ? containment_t::intersecting : containment_t::inside;
+#else
+    auto result = containment_t::inside;
+
+    for (uint32_t i = 0; i < PLANE_COUNT; i++) {
+        auto distance = frustum.x[i] * center.x + frustum.y[i] * center.y
+            + frustum.z[i] * center.z + frustum.w[i];
+        auto radius = std::abs(frustum.x[i]) * extent.x
+            + std::abs(frustum.y[i]) * extent.y
+            + std::abs(frustum.z[i]) * extent.z;
+
+        if (distance + radius < 0.0f)
+            return containment_t::outside;
+
+        if (distance - radius < 0.0f)
+            result = containment_t::intersecting;
+    }
+
+    return result;
+#endif
+}
+
+void bvh_t::build(std::span<const aabb_t> bounds)
+{
+    auto count = static_cast<uint32_t>(bounds.size());
+
+    m_indices.resize(count);
+    std::iota(m_indices.begin(), m_indices.end(), 0);
+
+    m_centers.resize(count);
+    for (uint32_t i = 0; i < count; i++)
+        m_centers[i] = (bounds[i].min + bounds[i].max) * 0.5f;
+
+    m_nodes.clear();
+    m_built_area = 0.0f;
+
+    if (!count)
+        return;
+
+    m_nodes.reserve(count / MAX_LEAF_SIZE * 2 + 1);
+    m_nodes.push_back({ .begin = 0, .end = count });
+
+    build_node(bounds, 0);
+
+    m_built_area = get_inner_area();
+}
+
+// splits the node at the median center along the longest axis of the
+// centers.
+void bvh_t::build_node(std::span<const aabb_t> bounds, uint32_t node)
+{
+    auto begin = m_nodes[node].begin;
+    auto end = m_nodes[node].end;
+
+    if (end - begin <= MAX_LEAF_SIZE) {
+        fit_leaf(bounds, &m_nodes[node]);
+        return;
+    }
+
+    auto center_min = m_centers[m_indices[begin]];
+    auto center_max = center_min;
+    for (auto i = begin + 1; i < end; i++) {
+        center_min = glm::min(center_min, m_centers[m_indices[i]]);
+        center_max = glm::max(center_max, m_centers[m_indices[i]]);
+    }
+
+    auto size = center_max - center_min;
+    auto axis = size.x > size.y ? (size.x > size.z ? 0 : 2)
+                                : (size.y > size.z ? 1 : 2);
+
+    auto middle = begin + (end - begin) / 2;
+    std::nth_element(m_indices.begin() + begin,
+                     m_indices.begin() + middle,
+                     m_indices.begin() + end,
+                     [this, axis](uint32_t lhs, uint32_t rhs) {
+                         return m_centers[lhs][axis] < m_centers[rhs][axis];
+                     });
+
+    auto child = static_cast<uint32_t>(m_nodes.size());
+    m_nodes[node].child = child;
+
+    m_nodes.push_back({ .begin = begin, .end = middle });
+    m_nodes.push_back({ .begin = middle, .end = end });
+
+    build_node(bounds, child);
+    build_node(bounds, child + 1);
+
+    m_nodes[node].bounds
+        = merge(m_nodes[child].bounds, m_nodes[child + 1].bounds);
+}
+
+void bvh_t::fit_leaf(std::span<const aabb_t> bounds, node_t* node) const
+{
+    node->bounds = bounds[m_indices[node->begin]];
+    for (auto i = node->begin + 1; i < node->end; i++)
+        node->bounds = merge(node->bounds, bounds[m_indices[i]]);
+}
+
+void bvh_t::refit(std::span<const aabb_t> bounds)
+{
+    // children come after their parents.
+    for (auto node = m_nodes.rbegin(); node != m_nodes.rend(); node++) {
+        if (node->child == node_t::NO_CHILD) {
+            fit_leaf(bounds, &*node);
+        } else {
+            node->bounds = merge(m_nodes[node->child].bounds,
+                                 m_nodes[node->child + 1].bounds);
+        }
+    }
+}
+
+float bvh_t::get_inner_area() const
+{
+    float area = 0.0f;
+    for (const auto& node : m_nodes) {
+        if (node.child != node_t::NO_CHILD)
+            area += get_area(node.bounds);
+    }
+
+    return area;
+}
+
+float bvh_t::get_cost() const
+{
+    if (m_built_area <= 0.0f)
+        return 1.0f;
+
+    return get_inner_area() / m_built_area;
+}
+
+size_t bvh_t::get_size() const
+{
+    return m_indices.size();
+}
+
+void bvh_t::cull(const frustum_t& frustum,
+                 std::span<const aabb_t> bounds,
+                 std::span<uint8_t> visible) const
+{
+    std::fill(visible.begin(), visible.end(), 0);
+
+    if (m_nodes.empty())
+        return;
+
+    // the tree is balanced, its depth stays far below the stack size.
+    uint32_t stack[64];
+    uint32_t stack_size = 0;
+
+    stack[stack_size++] = 0;
+
+    while (stack_size) {
+        const auto& node = m_nodes[stack[--stack_size]];
+
+        auto containment = classify(frustum, node.bounds);
+        if (containment == containment_t::outside)
+            continue;
+
+        // everything below a node inside the frustum is visible.
+        if (containment == containment_t::inside) {
+            for (auto i = node.begin; i < node.end; i++)
+                visible[m_indices[i]] = 1;
+
+            continue;
+        }
+
+        if (node.child != node_t::NO_CHILD) {
+            stack[stack_size++] = node.child;
+            stack[stack_size++] = node.child + 1;
+            continue;
+        }
+
+        for (auto i = node.begin; i < node.end; i++) {
+            auto index = m_indices[i];
+            if (classify(frustum, bounds[index]) != containment_t::outside)
+                visible[index] = 1;
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+struct aabb_t {
+    glm::vec3 min { 0.0f };
+    glm::vec3 max { 0.0f };
+};
+
+// bounds of `local` after transforming it by `matrix`.
+aabb_t transform_aabb(const aabb_t& local, const glm::mat4& matrix);
+
+// planes of a view frustum facing inwards, stored by component so an aabb is
+// tested against four planes at once. the last two planes are padding that
+// never rejects anything.
+struct frustum_t {
+    alignas(16) float x[8];
+    alignas(16) float y[8];
+    alignas(16) float z[8];
+    alignas(16) float w[8];
+};
+
+// extracts the planes of the clip volume of `view_projection`.
+frustum_t make_frustum(const glm::mat4& view_projection);
+
+// bounding volume hierarchy over a set of aabbs, referred to by their index
+// in the span passed to `build`. moving aabbs are handled by `refit`, which
+// keeps the tree but lets its quality degrade, `get_cost` tells how much.
+class bvh_t {
+public:
+    void build(std::span<const aabb_t> bounds);
+
+    // recomputes the node bounds for new aabbs, `bounds` must have the size
+    // the tree was built with.
+    void refit(std::span<const aabb_t> bounds);
+
+    // sum of the surface areas of the inner nodes, relative to the sum right
+    // after the last build.
+    float get_cost() const;
+
+    size_t get_size() const;
+
+    // sets `visible[i]` to 1 for every aabb of `bounds` that intersects
+    // `frustum` and to 0 for the rest. `bounds` are the aabbs of the last
+    // build or refit.
+    void cull(const frustum_t& frustum,
+              std::span<const aabb_t> bounds,
+              std::span<uint8_t> visible) const;
+
+private:
+    // every node covers the aabbs in `[begin, end)` of `m_indices`. inner
+    // nodes keep their children at `child` and `child + 1`, which is always
+    // after the parent, leaves have no child.
+    struct node_t {
+        static constexpr uint32_t NO_CHILD = 0;
+
+        aabb_t bounds;
+        uint32_t begin;
+        uint32_t end;
+        uint32_t child;
+    };
+
+    void build_node(std::span<const aabb_t> bounds, uint32_t node);
+
+    void fit_leaf(std::span<const aabb_t> bounds, node_t* node) const;
+
+    float get_inner_area() const;
+
+private:
+    std::vector<node_t> m_nodes;
+    std::vector<uint32_t> m_indices;
+    std::vector<glm::vec3> m_centers;
+
+    float m_built_area { 0.0f };
+};
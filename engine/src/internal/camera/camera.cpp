@@ -1,13 +1,13 @@
 #include "camera.h"
 
-#include <SDL3/SDL.h>
-
 glm::mat4 camera_t::get_projection_matrix(float fov,
                                           float window_width,
                                           float window_height) const
 {
-    return glm::perspective(
-        glm::radians(fov), window_width / window_height, 0.1f, 100.0f);
+    return glm::perspective(glm::radians(fov),
+                            window_width / window_height,
+                            NEAR_PLANE,
+                            FAR_PLANE);
 }
 
 glm::mat4 camera_t::get_view_matrix() const
@@ -26,14 +26,15 @@ void camera_t::update_camera()
     m_up = glm::normalize(glm::cross(m_right, m_front));
 }
 
-void camera_t::process_mouse()
+void camera_t::process_mouse(const input_state_t& input)
+{
+    m_mouse_look = true;
+    process_mouse_delta(input.mouse_delta);
+}
+
+void camera_t::process_mouse_delta(glm::vec2 delta)
 {
-    glm::vec2 mouse_offset;
-    {
-        float offset_x, offset_y;
-        SDL_GetRelativeMouseState(&offset_x, &offset_y);
-        mouse_offset = glm::vec2(offset_x, offset_y) * m_sensitivity;
-    }
+    auto mouse_offset = delta * m_sensitivity;
 
     m_yaw += mouse_offset.x;
     m_pitch -= mouse_offset.y;
@@ -47,21 +48,25 @@ void camera_t::process_mouse()
     update_camera();
 }
 
-void camera_t::process_keyboard(float delta_time)
+bool camera_t::has_mouse_look() const
+{
+    return m_mouse_look;
+}
+
+void camera_t::process_keyboard(const input_state_t& input, float delta_time)
 {
-    auto state = SDL_GetKeyboardState(nullptr);
     glm::vec3 direction(0.0f);
 
-    if (state[SDL_SCANCODE_W])
+    if (input.is_key_down(SDL_SCANCODE_W))
         direction += m_front;
 
-    if (state[SDL_SCANCODE_S])
+    if (input.is_key_down(SDL_SCANCODE_S))
         direction -= m_front;
 
-    if (state[SDL_SCANCODE_A])
+    if (input.is_key_down(SDL_SCANCODE_A))
         direction -= m_right;
 
-    if (state[SDL_SCANCODE_D])
+    if (input.is_key_down(SDL_SCANCODE_D))
         direction += m_right;
 
     // normalize the direction vector. this is because if we press W and A
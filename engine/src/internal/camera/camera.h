@@ -1,20 +1,31 @@
 #pragma once
 
+#include <input.h>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 class camera_t {
 public:
+    static constexpr float NEAR_PLANE = 0.1f;
+    static constexpr float FAR_PLANE = 100.0f;
+
     glm::mat4 get_projection_matrix(float fov,
                                     float window_width,
                                     float window_height) const;
 
     glm::mat4 get_view_matrix() const;
 
-    void process_mouse();
+    void process_mouse(const input_state_t& input);
+
+    // turns the camera by mouse motion that arrived after `process_mouse`.
+    void process_mouse_delta(glm::vec2 delta);
+
+    // whether the camera follows the mouse, set once `process_mouse` is used.
+    bool has_mouse_look() const;
 
-    void process_keyboard(float delta_time);
+    void process_keyboard(const input_state_t& input, float delta_time);
 
 private:
     void update_camera();
@@ -24,6 +35,7 @@ private:
     float m_pitch { 0.0f };
     float m_sensitivity { 0.2f };
     float m_speed { 5.0f };
+    bool m_mouse_look { false };
 
     glm::vec3 m_position {};
     glm::vec3 m_front {};
@@ -0,0 +1,38 @@
+#include <glad/glad.h>
+
+#include <memory_stats.h>
+
+#include "frame_uniforms.h"
+
+void frame_uniform_buffer_t::init()
+{
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    glBufferData(GL_UNIFORM_BUFFER,
+                 sizeof(frame_uniforms_t),
+                 nullptr,
+                 GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, m_buffer);
+
+    memory_tracker_t::track_gpu(memory_tracker_t::GPU_BUFFER_SCOPE,
+                                sizeof(frame_uniforms_t));
+}
+
+void frame_uniform_buffer_t::destroy()
+{
+    glDeleteBuffers(1, &m_buffer);
+    m_buffer = 0;
+
+    memory_tracker_t::track_gpu(
+        memory_tracker_t::GPU_BUFFER_SCOPE,
+        -static_cast<int64_t>(sizeof(frame_uniforms_t)));
+}
+
+void frame_uniform_buffer_t::update(const frame_uniforms_t& uniforms)
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(uniforms), &uniforms);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+// the std140 layout of the `frame_data` uniform block every shader declares:
+//
+//     layout (std140, binding = 0) uniform frame_data
+//     {
+//         mat4 u_projection;
+//         mat4 u_view;
+//         mat4 u_view_projection;
+//         vec4 u_viewport;
+//         float u_time;
+//         float u_delta_time;
+//     };
+struct frame_uniforms_t {
+    glm::mat4 projection { 1.0f };
+    glm::mat4 view { 1.0f };
+    glm::mat4 view_projection { 1.0f };
+
+    // the size of the viewport, and its inverse.
+    glm::vec4 viewport { 0.0f };
+
+    float time { 0.0f };
+    float delta_time { 0.0f };
+    float padding[2] {};
+};
+
+static_assert(sizeof(frame_uniforms_t) == 224,
+              "frame_uniforms_t has to match the std140 block");
+
+// the frame and view data shared by every shader. it is uploaded once per
+// frame and stays bound to `BINDING`, so programs only read it and nothing
+// is set per program or per draw.
+class frame_uniform_buffer_t {
+public:
+    static constexpr uint32_t BINDING = 0;
+    static constexpr const char* BLOCK_NAME = "frame_data";
+
+    void init();
+
+    void destroy();
+
+    void update(const frame_uniforms_t& uniforms);
+
+private:
+    uint32_t m_buffer { 0 };
+};
@@ -0,0 +1,98 @@
+#include <glad/glad.h>
+
+#include <cstring>
+
+#include "gpu_timer.h"
+
+void gpu_timer_t::init()
+{
+    m_supported = GLAD_GL_VERSION_3_3 && glGenQueries && glGetQueryObjectui64v;
+    if (!m_supported)
+        return;
+
+    for (auto& frame : m_frames)
+        glGenQueries(MAX_PASSES, frame.queries.data());
+}
+
+void gpu_timer_t::destroy()
+{
+    if (!m_supported)
+        return;
+
+    for (auto& frame : m_frames)
+        glDeleteQueries(MAX_PASSES, frame.queries.data());
+
+    m_supported = false;
+}
+
+void gpu_timer_t::begin_frame()
+{
+    if (!m_supported)
+        return;
+
+    m_frame = (m_frame + 1) % FRAME_LATENCY;
+
+    auto& frame = m_frames[m_frame];
+    for (uint32_t i = 0; i < frame.pass_count; i++) {
+        int32_t available = 0;
+        glGetQueryObjectiv(
+            frame.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+
+        // still in flight after `FRAME_LATENCY` frames, drop the sample
+        // rather than waiting for it.
+        if (!available)
+            continue;
+
+        uint64_t elapsed_ns = 0;
+        glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &elapsed_ns);
+
+        auto gpu_ms = static_cast<float>(elapsed_ns / 1.0e6);
+
+        uint32_t slot = 0;
+        while (slot < m_result_count
+               && std::strcmp(m_results[slot].name, frame.names[i]) != 0) {
+            slot++;
+        }
+
+        if (slot == m_result_count)
+            m_result_count++;
+
+        m_results[slot] = { .name = frame.names[i], .gpu_ms = gpu_ms };
+    }
+
+    frame.pass_count = 0;
+}
+
+void gpu_timer_t::begin_pass(const char* name)
+{
+    auto& frame = m_frames[m_frame];
+    if (!m_supported || m_in_pass || frame.pass_count == MAX_PASSES)
+        return;
+
+    frame.names[frame.pass_count] = name;
+    glBeginQuery(GL_TIME_ELAPSED, frame.queries[frame.pass_count]);
+
+    m_in_pass = true;
+}
+
+void gpu_timer_t::end_pass()
+{
+    if (!m_in_pass)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+
+    m_frames[m_frame].pass_count++;
+    m_in_pass = false;
+}
+
+void gpu_timer_t::collect(frame_timings_t* timings) const
+{
+    for (uint32_t i = 0; i < m_result_count; i++)
+        timings->find_pass(m_results[i].name)->gpu_ms = m_results[i].gpu_ms;
+}
+
+bool gpu_timer_t::is_supported() const
+{
+    return m_supported;
+}
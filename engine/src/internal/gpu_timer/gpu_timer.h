@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include <frame_timings.h>
+
+// measures the gpu time of render passes with `GL_TIME_ELAPSED` queries. the
+// queries of a frame are read back `FRAME_LATENCY` frames later, and only if
+// they are already available, so the cpu never waits on the gpu. every call
+// is a no-op when the context has no timer queries or no context exists.
+class gpu_timer_t {
+public:
+    static constexpr uint32_t FRAME_LATENCY = 4;
+    static constexpr uint32_t MAX_PASSES = 16;
+
+    void init();
+
+    void destroy();
+
+    void begin_frame();
+
+    // `name` has to outlive the timer, pass a string literal.
+    void begin_pass(const char* name);
+
+    void end_pass();
+
+    // copies the most recent gpu time of every pass into `timings`.
+    void collect(frame_timings_t* timings) const;
+
+    bool is_supported() const;
+
+private:
+    struct frame_queries_t {
+        std::array<uint32_t, MAX_PASSES> queries {};
+        std::array<const char*, MAX_PASSES> names {};
+
+        uint32_t pass_count { 0 };
+    };
+
+    struct pass_result_t {
+        const char* name;
+        float gpu_ms;
+    };
+
+    std::array<frame_queries_t, FRAME_LATENCY> m_frames {};
+    std::array<pass_result_t, MAX_PASSES> m_results {};
+
+    uint32_t m_result_count { 0 };
+    uint32_t m_frame { 0 };
+
+    bool m_supported { false };
+    bool m_in_pass { false };
+};
@@ -0,0 +1,264 @@
+#include <algorithm>
+#include <cmath>
+
+#ifdef __SSE__
+    #include <xmmintrin.h>
+#endif
+
+#include "light_clusters.h"
+
+// the bounds are read four clusters at a time, the padding keeps the last
+// row in range.
+static constexpr uint32_t BOUNDS_PADDING = 3;
+
+static uint32_t get_tile(float ndc, uint32_t tiles)
+{
+    auto tile = static_cast<int32_t>(std::floor((ndc + 1.0f) * 0.5f * tiles));
+    return static_cast<uint32_t>(
+        std::clamp(tile, 0, static_cast<int32_t>(tiles) - 1));
+}
+
+void light_clusters_t::set_projection(const glm::mat4& projection,
+                                      float near_plane,
+                                      float far_plane)
+{
+    m_near_plane = near_plane;
+    m_far_plane = far_plane;
+    m_scale_x = projection[0][0];
+    m_scale_y = projection[1][1];
+
+    for (auto bounds :
+         { &m_min_x, &m_min_y, &m_min_z, &m_max_x, &m_max_y, &m_max_z }) {
+        bounds->assign(CLUSTER_COUNT + BOUNDS_PADDING, 0.0f);
+    }
+
+    for (uint32_t z = 0; z < SLICES; z++) {
+        auto ratio = far_plane / near_plane;
+        auto near_depth = near_plane
+            * std::pow(ratio, static_cast<float>(z) / SLICES);
+        auto far_depth = near_plane
+            * std::pow(ratio, static_cast<float>(z + 1) / SLICES);
+
+        for (uint32_t y = 0; y < TILES_Y; y++) {
+            auto y0 = -1.0f + 2.0f * y / TILES_Y;
+            auto y1 = -1.0f + 2.0f * (y + 1) / TILES_Y;
+
+            for (uint32_t x = 0; x < TILES_X; x++) {
+                auto x0 = -1.0f + 2.0f * x / TILES_X;
+                auto x1 = -1.0f + 2.0f * (x + 1) / TILES_X;
+
+                auto i = x + TILES_X * (y + TILES_Y * z);
+
+                // the tile widens with the depth, so the extremes are on
+                // either the near or the far side.
+                m_min_x[i] = std::min(x0 * near_depth, x0 * far_depth)
+                    / m_scale_x;
+                m_max_x[i] = std::max(x1 * near_depth, x1 * far_depth)
+                    / m_scale_x;
+                m_min_y[i] = std::min(y0 * near_depth, y0 * far_depth)
+                    / m_scale_y;
+                m_max_y[i] = std::max(y1 * near_depth, y1 * far_depth)
+                    / m_scale_y;
+                m_min_z[i] = -far_depth;
+                m_max_z[i] = -near_depth;
+            }
+        }
+    }
+}
+
+uint32_t light_clusters_t::get_slice(float depth) const
+{
+    if (depth <= m_near_plane)
+        return 0;
+
+    auto slice = static_cast<uint32_t>(std::log(depth) * get_slice_scale()
+                                       + get_slice_bias());
+    return std::min(slice, SLICES - 1);
+}
+
+// conservative range of clusters touched by the bounding box of the light.
+bool light_clusters_t::get_cluster_range(const glm::vec4& light,
+                                         cluster_range_t* range) const
+{
+    auto radius = light.w;
+    auto depth = -light.z;
+
+    auto min_depth = std::max(depth - radius, m_near_plane);
+    auto max_depth = std::min(depth + radius, m_far_plane);
+    if (min_depth > max_depth)
+        return false;
+
+    // the closest depth gives the widest projection of a coordinate.
+    auto project = [min_depth, max_depth](float value, bool lower) {
+        return value / ((value < 0.0f) == lower ? min_depth : max_depth);
+    };
+
+    auto min_x = project(light.x - radius, true) * m_scale_x;
+    auto max_x = project(light.x + radius, false) * m_scale_x;
+    auto min_y = project(light.y - radius, true) * m_scale_y;
+    auto max_y = project(light.y + radius, false) * m_scale_y;
+
+    if (max_x < -1.0f || min_x > 1.0f || max_y < -1.0f || min_y > 1.0f)
+        return false;
+
+    *range = {
+        .min = { get_tile(min_x, TILES_X),
+                 get_tile(min_y, TILES_Y),
+                 get_slice(min_depth) },
+        .max = { get_tile(max_x, TILES_X),
+                 get_tile(max_y, TILES_Y),
+                 get_slice(max_depth) },
+    };
+
+    return true;
+}
+
+void light_clusters_t::cull(const glm::mat4& view,
+                            std::span<const glm::vec4> lights)
+{
+    if (m_min_x.empty()) {
+        m_offsets.assign(CLUSTER_COUNT + 1, 0);
+        return;
+    }
+
+    m_view_lights.resize(lights.size());
+
+#ifdef __SSE__
+    auto v0 = _mm_loadu_ps(&view[0][0]);
+    auto v1 = _mm_loadu_ps(&view[1][0]);
+    auto v2 = _mm_loadu_ps(&view[2][0]);
+    auto v3 = _mm_loadu_ps(&view[3][0]);
+
+    for (size_t i = 0; i < lights.size(); i++) {
+        auto position = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(v0, _mm_set1_ps(lights[i].x)),
+                       _mm_mul_ps(v1, _mm_set1_ps(lights[i].y))),
+            _mm_add_ps(_mm_mul_ps(v2, _mm_set1_ps(lights[i].z)), v3));
+
+        _mm_storeu_ps(&m_view_lights[i].x, position);
+        m_view_lights[i].w = lights[i].w;
+    }
+#else
+    for (size_t i = 0; i < lights.size(); i++) {
+        m_view_lights[i] = view * glm::vec4(glm::vec3(lights[i]), 1.0f);
+        m_view_lights[i].w = lights[i].w;
+    }
+#endif
+
+    m_pair_clusters.clear();
+    m_pair_lights.clear();
+
+    for (uint32_t light = 0; light < m_view_lights.size(); light++) {
+        const auto& center = m_view_lights[light];
+
+        cluster_range_t range;
+        if (!get_cluster_range(center, &range))
+            continue;
+
+        auto radius_squared = center.w * center.w;
+
+        for (auto z = range.min[2]; z <= range.max[2]; z++) {
+            for (auto y = range.min[1]; y <= range.max[1]; y++) {
+                auto row = TILES_X * (y + TILES_Y * z);
+
+#ifdef __SSE__
+                auto cx = _mm_set1_ps(center.x);
+                auto cy = _mm_set1_ps(center.y);
+                auto cz = _mm_set1_ps(center.z);
+                auto zero = _mm_setzero_ps();
+
+                // squared distance from the center to the cluster bounds.
+                auto distance = [zero](__m128 c, const float* min,
+                                       const float* max) {
+                    auto d = _mm_max_ps(
+                        _mm_sub_ps(_mm_loadu_ps(min), c),
+                        _mm_sub_ps(c, _mm_loadu_ps(max)));
+                    d = _mm_max_ps(d, zero);
+                    return _mm_mul_ps(d, d);
+                };
+
+                for (auto x = range.min[0]; x <= range.max[0]; x += 4) {
+                    auto i = row + x;
+
+                    auto squared = _mm_add_ps(
+                        _mm_add_ps(
+                            distance(cx, &m_min_x[i], &m_max_x[i]),
+                            distance(cy, &m_min_y[i], &m_max_y[i])),
+                        distance(cz, &m_min_z[i], &m_max_z[i]));
+
+                    auto mask = _mm_movemask_ps(
+                        _mm_cmple_ps(squared, _mm_set1_ps(radius_squared)));
+
+                    auto count = std::min(4u, range.max[0] - x + 1);
+                    for (uint32_t lane = 0; lane < count; lane++) {
+                        if (mask & (1 << lane)) {
+                            m_pair_clusters.push_back(i + lane);
+                            m_pair_lights.push_back(light);
+                        }
+                    }
+                }
+#else
+                for (auto x = range.min[0]; x <= range.max[0]; x++) {
+                    auto i = row + x;
+
+                    auto distance = [](float c, float min, float max) {
+                        auto d = std::max({ min - c, c - max, 0.0f });
+                        return d * d;
+                    };
+
+                    auto squared = distance(center.x, m_min_x[i], m_max_x[i])
+                        + distance(center.y, m_min_y[i], m_max_y[i])
+                        + distance(center.z, m_min_z[i], m_max_z[i]);
+
+                    if (squared <= radius_squared) {
+                        m_pair_clusters.push_back(i);
+                        m_pair_lights.push_back(light);
+                    }
+                }
+#endif
+            }
+        }
+    }
+
+    // counting sort of the pairs by cluster, lights keep their order.
+    m_offsets.assign(CLUSTER_COUNT + 1, 0);
+    for (auto cluster : m_pair_clusters)
+        m_offsets[cluster + 1]++;
+
+    for (uint32_t i = 0; i < CLUSTER_COUNT; i++)
+        m_offsets[i + 1] += m_offsets[i];
+
+    m_light_indices.resize(m_pair_lights.size());
+    for (size_t i = 0; i < m_pair_clusters.size(); i++)
+        m_light_indices[m_offsets[m_pair_clusters[i]]++] = m_pair_lights[i];
+
+    // filling advanced every offset to the start of the next cluster.
+    for (uint32_t i = CLUSTER_COUNT; i > 0; i--)
+        m_offsets[i] = m_offsets[i - 1];
+    m_offsets[0] = 0;
+}
+
+std::span<const uint32_t> light_clusters_t::get_offsets() const
+{
+    return m_offsets;
+}
+
+std::span<const uint32_t> light_clusters_t::get_light_indices() const
+{
+    return m_light_indices;
+}
+
+std::span<const glm::vec4> light_clusters_t::get_view_lights() const
+{
+    return m_view_lights;
+}
+
+float light_clusters_t::get_slice_scale() const
+{
+    return SLICES / std::log(m_far_plane / m_near_plane);
+}
+
+float light_clusters_t::get_slice_bias() const
+{
+    return -std::log(m_near_plane) * get_slice_scale();
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// assigns point lights to the clusters of a view frustum: `TILES_X` by
+// `TILES_Y` screen tiles, each split into `SLICES` depth slices that grow
+// exponentially with the distance to the camera. culling runs on the cpu, the
+// results are laid out to be uploaded to the gpu as is.
+class light_clusters_t {
+public:
+    static constexpr uint32_t TILES_X = 16;
+    static constexpr uint32_t TILES_Y = 9;
+    static constexpr uint32_t SLICES = 24;
+    static constexpr uint32_t CLUSTER_COUNT = TILES_X * TILES_Y * SLICES;
+
+    // recomputes the bounds of the clusters, only needed when the projection
+    // changes. `projection` has to be a symmetric perspective projection.
+    void set_projection(const glm::mat4& projection,
+                        float near_plane,
+                        float far_plane);
+
+    // `lights` are world space positions with the radius in `w`.
+    void cull(const glm::mat4& view, std::span<const glm::vec4> lights);
+
+    // lights of cluster `i` are `get_light_indices()[offsets[i]]` up to
+    // `offsets[i + 1]`, cluster `i` is `x + TILES_X * (y + TILES_Y * z)`.
+    std::span<const uint32_t> get_offsets() const;
+
+    std::span<const uint32_t> get_light_indices() const;
+
+    // view space positions with the radius in `w`, by light index.
+    std::span<const glm::vec4> get_view_lights() const;
+
+    // `slice = log(depth) * scale + bias`, for the lookup in shaders.
+    float get_slice_scale() const;
+
+    float get_slice_bias() const;
+
+private:
+    struct cluster_range_t {
+        uint32_t min[3];
+        uint32_t max[3];
+    };
+
+    bool get_cluster_range(const glm::vec4& light,
+                           cluster_range_t* range) const;
+
+    uint32_t get_slice(float depth) const;
+
+private:
+    float m_near_plane { 0.1f };
+    float m_far_plane { 100.0f };
+
+    // `projection[0][0]` and `projection[1][1]`.
+    float m_scale_x { 1.0f };
+    float m_scale_y { 1.0f };
+
+    // bounds of every cluster in view space, by component so four clusters
+    // of a row are tested at once.
+    std::vector<float> m_min_x;
+    std::vector<float> m_min_y;
+    std::vector<float> m_min_z;
+    std::vector<float> m_max_x;
+    std::vector<float> m_max_y;
+    std::vector<float> m_max_z;
+
+    std::vector<glm::vec4> m_view_lights;
+
+    // (cluster, light) pairs, sorted by cluster into `m_light_indices`.
+    std::vector<uint32_t> m_pair_clusters;
+    std::vector<uint32_t> m_pair_lights;
+
+    std::vector<uint32_t> m_offsets;
+    std::vector<uint32_t> m_light_indices;
+};
@@ -0,0 +1,170 @@
+#include "mapped_file.h"
+
+#include <format>
+#include <utility>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+mapped_file_t::~mapped_file_t()
+{
+    close();
+}
+
+mapped_file_t::mapped_file_t(mapped_file_t&& other)
+    : m_data(std::exchange(other.m_data, nullptr))
+    , m_size(std::exchange(other.m_size, 0))
+#ifdef _WIN32
+    , m_file(std::exchange(other.m_file, nullptr))
+    , m_mapping(std::exchange(other.m_mapping, nullptr))
+#endif
+{
+}
+
+mapped_file_t& mapped_file_t::operator=(mapped_file_t&& other)
+{
+    if (this != &other) {
+        close();
+
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+#ifdef _WIN32
+        m_file = std::exchange(other.m_file, nullptr);
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+    }
+
+    return *this;
+}
+
+#ifdef _WIN32
+
+std::expected<void, std::string> mapped_file_t::open(const fs::path& path)
+{
+    close();
+
+    HANDLE file = CreateFileW(path.c_str(),
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              nullptr,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return std::unexpected(
+            std::format("can't open file '{}'", path.string()));
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return std::unexpected(
+            std::format("can't query the size of '{}'", path.string()));
+    }
+
+    m_file = file;
+    m_size = static_cast<size_t>(size.QuadPart);
+
+    if (m_size == 0)
+        return {};
+
+    m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping) {
+        close();
+        return std::unexpected(
+            std::format("can't map file '{}'", path.string()));
+    }
+
+    m_data = static_cast<const std::byte*>(
+        MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_data) {
+        close();
+        return std::unexpected(
+            std::format("can't map file '{}'", path.string()));
+    }
+
+    return {};
+}
+
+void mapped_file_t::close()
+{
+    if (m_data)
+        UnmapViewOfFile(m_data);
+
+    if (m_mapping)
+        CloseHandle(m_mapping);
+
+    if (m_file)
+        CloseHandle(m_file);
+
+    m_data = nullptr;
+    m_size = 0;
+    m_file = nullptr;
+    m_mapping = nullptr;
+}
+
+#else
+
+std::expected<void, std::string> mapped_file_t::open(const fs::path& path)
+{
+    close();
+
+    int32_t fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return std::unexpected(
+            std::format("can't open file '{}'", path.string()));
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return std::unexpected(
+            std::format("can't query the size of '{}'", path.string()));
+    }
+
+    if (info.st_size == 0) {
+        ::close(fd);
+        return {};
+    }
+
+    auto size = static_cast<size_t>(info.st_size);
+    auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // the mapping keeps its own reference to the file.
+    ::close(fd);
+
+    if (data == MAP_FAILED) {
+        return std::unexpected(
+            std::format("can't map file '{}'", path.string()));
+    }
+
+    madvise(data, size, MADV_WILLNEED);
+
+    m_data = static_cast<const std::byte*>(data);
+    m_size = size;
+
+    return {};
+}
+
+void mapped_file_t::close()
+{
+    if (m_data)
+        munmap(const_cast<std::byte*>(m_data), m_size);
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#endif
+
+std::span<const std::byte> mapped_file_t::get_data() const
+{
+    return { m_data, m_size };
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <span>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// read-only view of a whole file mapped into memory.
+class mapped_file_t {
+public:
+    mapped_file_t() { };
+    ~mapped_file_t();
+
+    mapped_file_t(const mapped_file_t& other) = delete;
+    mapped_file_t& operator=(const mapped_file_t& other) = delete;
+
+    mapped_file_t(mapped_file_t&& other);
+    mapped_file_t& operator=(mapped_file_t&& other);
+
+    std::expected<void, std::string> open(const fs::path& path);
+
+    void close();
+
+    std::span<const std::byte> get_data() const;
+
+private:
+    const std::byte* m_data { nullptr };
+    size_t m_size { 0 };
+
+#ifdef _WIN32
+    void* m_file { nullptr };
+    void* m_mapping { nullptr };
+#endif
+};
@@ -1,11 +1,13 @@
 #include <glad/glad.h>
 
-#include <tiny_obj_loader.h>
-
+#include <algorithm>
 #include <optional>
 #include <print>
 #include <unordered_map>
 
+#include <memory_stats.h>
+#include <obj_parser/obj_parser.h>
+
 #include "model.h"
 
 namespace std
@@ -29,88 +31,76 @@ struct hash<vertex_t> {
 
 }
 
-std::optional<model_t> load_model(const fs::path& path)
+std::optional<model_t> load_model(const fs::path& path,
+                                  const texture_loader_t& load_texture)
 {
-    tinyobj::ObjReader reader;
-
-    if (!reader.ParseFromFile(path)) {
-        if (!reader.Error().empty()) {
-            std::println(stderr,
-                         "ERROR: failed to load model '{}': {}",
-                         path.string(),
-                         reader.Error());
-            return {};
-        }
-    }
-
-    if (!reader.Warning().empty()) {
+    auto data = parse_obj(path);
+    if (!data) {
         std::println(stderr,
-                     "WARNING: from tinyobjloader in '{}': {}",
+                     "ERROR: failed to load model '{}': {}",
                      path.string(),
-                     reader.Warning());
+                     data.error());
+        return {};
+    }
+
+    if (!data->warning.empty()) {
+        std::println(
+            stderr, "WARNING: from '{}': {}", path.string(), data->warning);
     }
 
-    const auto& attrib = reader.GetAttrib();
-    const auto& shapes = reader.GetShapes();
-    const auto& materials = reader.GetMaterials();
+    const auto& materials = data->materials;
 
     struct mesh_data_t {
         std::vector<vertex_t> vertices;
         std::vector<uint32_t> indices;
     };
 
-    std::unordered_map<uint32_t, mesh_data_t> material_meshes;
+    std::unordered_map<int32_t, mesh_data_t> material_meshes;
     std::unordered_map<vertex_t, uint32_t> vertex_to_index;
 
-    for (int32_t s = 0; s < shapes.size(); s++) {
-        int32_t index_offset = 0;
+    for (size_t t = 0; t < data->material_ids.size(); t++) {
+        int32_t mat_id = data->material_ids[t];
 
-        for (int32_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); f++) {
-            int32_t fv = shapes[s].mesh.num_face_vertices[f];
-            int32_t mat_id = shapes[s].mesh.material_ids[f];
+        if (!material_meshes.contains(mat_id))
+            material_meshes[mat_id] = mesh_data_t {};
 
-            if (!material_meshes.contains(mat_id))
-                material_meshes[mat_id] = mesh_data_t {};
+        auto& mesh = material_meshes[mat_id];
 
-            auto& mesh = material_meshes[mat_id];
+        for (size_t v = 0; v < 3; v++) {
+            const auto& idx = data->indices[3 * t + v];
 
-            for (int32_t v = 0; v < fv; v++) {
-                tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
+            vertex_t vertex;
+            vertex.position
+                = glm::vec3(data->positions[3 * idx.position + 0],
+                            data->positions[3 * idx.position + 1],
+                            data->positions[3 * idx.position + 2]);
 
-                vertex_t vertex;
-                vertex.position
-                    = glm::vec3(attrib.vertices[3 * idx.vertex_index + 0],
-                                attrib.vertices[3 * idx.vertex_index + 1],
-                                attrib.vertices[3 * idx.vertex_index + 2]);
-
-                if (idx.normal_index >= 0) {
-                    vertex.normal
-                        = glm::vec3(attrib.normals[3 * idx.normal_index + 0],
-                                    attrib.normals[3 * idx.normal_index + 1],
-                                    attrib.normals[3 * idx.normal_index + 2]);
-                }
-
-                if (idx.texcoord_index >= 0) {
-                    vertex.uv = glm::vec2(
-                        attrib.texcoords[2 * idx.texcoord_index + 0],
-                        attrib.texcoords[2 * idx.texcoord_index + 1]);
-                }
+            if (idx.normal >= 0) {
+                vertex.normal = glm::vec3(data->normals[3 * idx.normal + 0],
+                                          data->normals[3 * idx.normal + 1],
+                                          data->normals[3 * idx.normal + 2]);
+            }
 
-                if (!vertex_to_index.contains(vertex)) {
-                    uint32_t index = mesh.vertices.size();
-                    vertex_to_index[vertex] = index;
-                    mesh.vertices.push_back(vertex);
-                }
+            if (idx.texcoord >= 0) {
+                vertex.uv = glm::vec2(data->texcoords[2 * idx.texcoord + 0],
+                                      data->texcoords[2 * idx.texcoord + 1]);
+            }
 
-                mesh.indices.push_back(vertex_to_index[vertex]);
+            if (!vertex_to_index.contains(vertex)) {
+                uint32_t index = mesh.vertices.size();
+                vertex_to_index[vertex] = index;
+                mesh.vertices.push_back(vertex);
             }
 
-            index_offset += fv;
+            mesh.indices.push_back(vertex_to_index[vertex]);
         }
     }
 
     model_t model;
 
+    // materials often share their textures.
+    std::unordered_map<std::string, uint32_t> loaded_textures;
+
     int32_t mat_index = 0;
     for (auto& [mat_id, mesh_data] : material_meshes) {
         mesh_t mesh;
@@ -118,6 +108,19 @@ std::optional<model_t> load_model(const fs::path& path)
         mesh.vertices = std::move(mesh_data.vertices);
         mesh.indices = std::move(mesh_data.indices);
 
+        mesh.bounds = { mesh.vertices[0].position, mesh.vertices[0].position };
+        for (const auto& vertex : mesh.vertices) {
+            mesh.bounds.min = glm::min(mesh.bounds.min, vertex.position);
+            mesh.bounds.max = glm::max(mesh.bounds.max, vertex.position);
+        }
+
+        if (model.meshes.empty()) {
+            model.bounds = mesh.bounds;
+        } else {
+            model.bounds.min = glm::min(model.bounds.min, mesh.bounds.min);
+            model.bounds.max = glm::max(model.bounds.max, mesh.bounds.max);
+        }
+
         glGenVertexArrays(1, &mesh.vao);
         glBindVertexArray(mesh.vao);
 
@@ -136,6 +139,11 @@ std::optional<model_t> load_model(const fs::path& path)
                      mesh.indices.data(),
                      GL_STATIC_DRAW);
 
+        memory_tracker_t::track_gpu(
+            memory_tracker_t::GPU_BUFFER_SCOPE,
+            sizeof(vertex_t) * mesh.vertices.size()
+                + sizeof(uint32_t) * mesh.indices.size());
+
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(
             0,
@@ -167,15 +175,50 @@ std::optional<model_t> load_model(const fs::path& path)
 
         mesh.mat_index = mat_index++;
 
+        // faces without a known material get tinyobjloader's default diffuse
+        // color.
+        tinyobj::material_t source {};
+        if (mat_id >= 0 && mat_id < materials.size())
+            source = materials[mat_id];
+        else
+            std::fill_n(source.diffuse, 3, 0.6f);
+
         material_t material;
-        material.diff_color = glm::vec3(materials[mat_id].diffuse[0],
-                                        materials[mat_id].diffuse[1],
-                                        materials[mat_id].diffuse[2]);
+        material.diff_color = glm::vec3(
+            source.diffuse[0], source.diffuse[1], source.diffuse[2]);
         material.diff_texture = 0;
 
+        const auto& texname = source.diffuse_texname;
+        if (load_texture && !texname.empty()) {
+            if (!loaded_textures.contains(texname)) {
+                loaded_textures[texname]
+                    = load_texture(path.parent_path() / texname);
+            }
+
+            material.diff_texture = loaded_textures[texname];
+        }
+
         model.materials.push_back(material);
         model.meshes.push_back(std::move(mesh));
     }
 
     return model;
 }
+
+void unload_model(model_t* model)
+{
+    for (auto& mesh : model->meshes) {
+        glDeleteVertexArrays(1, &mesh.vao);
+        glDeleteBuffers(1, &mesh.vbo);
+        glDeleteBuffers(1, &mesh.ebo);
+
+        memory_tracker_t::track_gpu(
+            memory_tracker_t::GPU_BUFFER_SCOPE,
+            -static_cast<int64_t>(sizeof(vertex_t) * mesh.vertices.size()
+                                  + sizeof(uint32_t) * mesh.indices.size()));
+
+        mesh.vao = 0;
+        mesh.vbo = 0;
+        mesh.ebo = 0;
+    }
+}
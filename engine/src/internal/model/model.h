@@ -3,7 +3,11 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <bvh/bvh.h>
+
 #include <filesystem>
+#include <functional>
+#include <optional>
 
 namespace fs = std::filesystem;
 
@@ -56,6 +60,7 @@ struct mesh_t {
         , vbo(other.vbo)
         , ebo(other.ebo)
         , mat_index(other.mat_index)
+        , bounds(other.bounds)
     {
         other.vao = 0;
         other.vbo = 0;
@@ -74,6 +79,7 @@ struct mesh_t {
         vbo = other.vbo;
         ebo = other.ebo;
         mat_index = other.mat_index;
+        bounds = other.bounds;
 
         other.vao = 0;
         other.vbo = 0;
@@ -93,6 +99,9 @@ struct mesh_t {
     uint32_t ebo {};
 
     int32_t mat_index {};
+
+    // in model space.
+    aabb_t bounds;
 };
 
 struct model_t {
@@ -103,6 +112,7 @@ struct model_t {
     model_t(model_t&& other)
         : meshes(std::move(other.meshes))
         , materials(std::move(other.materials))
+        , bounds(other.bounds)
     {
     }
 
@@ -112,6 +122,7 @@ struct model_t {
     {
         meshes = std::move(other.meshes);
         materials = std::move(other.materials);
+        bounds = other.bounds;
 
         return *this;
     }
@@ -120,6 +131,19 @@ struct model_t {
 
     std::vector<mesh_t> meshes;
     std::vector<material_t> materials;
+
+    // union of the bounds of all meshes.
+    aabb_t bounds;
 };
 
-std::optional<model_t> load_model(const fs::path& path);
+// returns the texture object for an image referenced by a material, or 0 if
+// it can't be loaded.
+using texture_loader_t = std::function<uint32_t(const fs::path& path)>;
+
+// diffuse textures are loaded through `load_texture` when one is given,
+// otherwise materials are left without textures.
+std::optional<model_t> load_model(const fs::path& path,
+                                  const texture_loader_t& load_texture = {});
+
+// releases the gpu objects of `model`.
+void unload_model(model_t* model);
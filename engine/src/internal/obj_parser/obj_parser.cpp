@@ -0,0 +1,623 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <map>
+#include <spanstream>
+#include <string_view>
+#include <thread>
+
+#include <pack/pack.h>
+
+#include "obj_parser.h"
+
+// files are only split when every chunk gets at least this much.
+static constexpr size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+// faces before the first `usemtl` of a chunk use the material that was
+// current at the end of the previous chunk.
+static constexpr int32_t INHERITED_MATERIAL = -2;
+
+struct attribute_counts_t {
+    uint32_t positions;
+    uint32_t normals;
+    uint32_t texcoords;
+};
+
+struct chunk_t {
+    std::string_view text;
+
+    std::vector<float> positions;
+    std::vector<float> normals;
+    std::vector<float> texcoords;
+
+    // indices as written in the file, resolved once the attribute counts of
+    // the previous chunks are known.
+    std::vector<obj_index_t> face_vertices;
+    std::vector<uint32_t> face_sizes;
+    std::vector<attribute_counts_t> face_counts;
+
+    // the line of every face, counted from the start of the chunk.
+    std::vector<uint32_t> face_lines;
+    uint32_t line_count { 0 };
+
+    // index into `material_names` or `INHERITED_MATERIAL`.
+    std::vector<int32_t> face_materials;
+    std::vector<std::string> material_names;
+
+    std::vector<std::string> material_libraries;
+
+    attribute_counts_t base;
+    uint32_t first_line;
+    std::vector<int32_t> material_ids;
+    int32_t inherited_material;
+
+    std::vector<obj_index_t> indices;
+    std::vector<int32_t> triangle_materials;
+
+    std::string warning;
+
+    // set for the first face that references a missing attribute.
+    std::string error;
+};
+
+template<typename Func>
+static void run_parallel(size_t count, Func func)
+{
+    std::vector<std::thread> threads;
+    threads.reserve(count - 1);
+
+    for (size_t i = 1; i < count; i++)
+        threads.emplace_back(func, i);
+
+    func(0);
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static void skip_spaces(const char** it, const char* end)
+{
+    while (*it < end && is_space(**it))
+        (*it)++;
+}
+
+static float parse_float(const char** it, const char* end)
+{
+    skip_spaces(it, end);
+
+    if (*it < end && **it == '+')
+        (*it)++;
+
+    float value = 0.0f;
+    auto result = std::from_chars(*it, end, value);
+    if (result.ec == std::errc {})
+        *it = result.ptr;
+
+    return value;
+}
+
+static int32_t parse_int(const char** it, const char* end)
+{
+    auto negative = *it < end && **it == '-';
+    if (negative)
+        (*it)++;
+
+    int32_t value = 0;
+    while (*it < end && **it >= '0' && **it <= '9') {
+        value = value * 10 + (**it - '0');
+        (*it)++;
+    }
+
+    return negative ? -value : value;
+}
+
+static std::string_view parse_word(const char** it, const char* end)
+{
+    skip_spaces(it, end);
+
+    auto begin = *it;
+    while (*it < end && !is_space(**it))
+        (*it)++;
+
+    return { begin, static_cast<size_t>(*it - begin) };
+}
+
+// `v`, `v/vt`, `v//vn` or `v/vt/vn`. missing indices are stored as 0, which
+// is not a valid obj index.
+static obj_index_t parse_face_vertex(const char** it, const char* end)
+{
+    obj_index_t index { parse_int(it, end), 0, 0 };
+
+    if (*it < end && **it == '/') {
+        (*it)++;
+
+        if (*it < end && **it != '/')
+            index.texcoord = parse_int(it, end);
+
+        if (*it < end && **it == '/') {
+            (*it)++;
+            index.normal = parse_int(it, end);
+        }
+    }
+
+    return index;
+}
+
+static void parse_line(chunk_t* chunk, const char* it, const char* end)
+{
+    skip_spaces(&it, end);
+    if (it == end || *it == '#')
+        return;
+
+    auto keyword = parse_word(&it, end);
+
+    if (keyword == "v") {
+        for (int32_t i = 0; i < 3; i++)
+            chunk->positions.push_back(parse_float(&it, end));
+    } else if (keyword == "vn") {
+        for (int32_t i = 0; i < 3; i++)
+            chunk->normals.push_back(parse_float(&it, end));
+    } else if (keyword == "vt") {
+        for (int32_t i = 0; i < 2; i++)
+            chunk->texcoords.push_back(parse_float(&it, end));
+    } else if (keyword == "f") {
+        uint32_t size = 0;
+
+        skip_spaces(&it, end);
+        while (it < end) {
+            chunk->face_vertices.push_back(parse_face_vertex(&it, end));
+            size++;
+
+            skip_spaces(&it, end);
+        }
+
+        chunk->face_sizes.push_back(size);
+        chunk->face_lines.push_back(chunk->line_count);
+        chunk->face_counts.push_back({
+            .positions = static_cast<uint32_t>(chunk->positions.size() / 3),
+            .normals = static_cast<uint32_t>(chunk->normals.size() / 3),
+            .texcoords = static_cast<uint32_t>(chunk->texcoords.size() / 2),
+        });
+        chunk->face_materials.push_back(
+            chunk->material_names.empty()
+                ? INHERITED_MATERIAL
+                : static_cast<int32_t>(chunk->material_names.size() - 1));
+    } else if (keyword == "usemtl") {
+        chunk->material_names.emplace_back(parse_word(&it, end));
+    } else if (keyword == "mtllib") {
+        skip_spaces(&it, end);
+        chunk->material_libraries.emplace_back(it, end);
+    }
+}
+
+static void parse_chunk(chunk_t* chunk)
+{
+    auto it = chunk->text.data();
+    auto end = it + chunk->text.size();
+
+    while (it < end) {
+        auto line_end
+            = static_cast<const char*>(std::memchr(it, '\n', end - it));
+        if (!line_end)
+            line_end = end;
+
+        chunk->line_count++;
+        parse_line(chunk, it, line_end);
+        it = line_end + 1;
+    }
+}
+
+static int32_t resolve_index(int32_t index, uint32_t base, uint32_t count)
+{
+    if (index > 0)
+        return index - 1;
+
+    // relative to the attributes defined so far.
+    if (index < 0)
+        return static_cast<int32_t>(base + count) + index;
+
+    return -1;
+}
+
+// whether `index` references one of `count` attributes. an absent index
+// passes, it resolves to -1.
+static bool is_valid_index(int32_t raw, int32_t index, uint32_t count)
+{
+    return raw == 0 || (index >= 0 && static_cast<uint32_t>(index) < count);
+}
+
+template<typename T>
+static int32_t point_in_triangle(const T* x, const T* y, T test_x, T test_y)
+{
+    int32_t inside = 0;
+    for (int32_t i = 0, j = 2; i < 3; j = i++) {
+        if (((y[i] > test_y) != (y[j] > test_y))
+            && (test_x
+                < (x[j] - x[i]) * (test_y - y[i]) / (y[j] - y[i]) + x[i])) {
+            inside = !inside;
+        }
+    }
+
+    return inside;
+}
+
+// ear clipping, a port of tinyobjloader's built-in triangulation so polygons
+// are split exactly like before.
+static void triangulate_polygon(const std::vector<float>& v,
+                                std::vector<obj_index_t> polygon,
+                                std::vector<obj_index_t>* out)
+{
+    auto npolys = polygon.size();
+
+    size_t axes[2] = { 1, 2 };
+    for (size_t k = 0; k < npolys; k++) {
+        auto vi0 = static_cast<size_t>(polygon[(k + 0) % npolys].position);
+        auto vi1 = static_cast<size_t>(polygon[(k + 1) % npolys].position);
+        auto vi2 = static_cast<size_t>(polygon[(k + 2) % npolys].position);
+
+        if (3 * vi0 + 2 >= v.size() || 3 * vi1 + 2 >= v.size()
+            || 3 * vi2 + 2 >= v.size()) {
+            continue;
+        }
+
+        auto e0x = v[vi1 * 3 + 0] - v[vi0 * 3 + 0];
+        auto e0y = v[vi1 * 3 + 1] - v[vi0 * 3 + 1];
+        auto e0z = v[vi1 * 3 + 2] - v[vi0 * 3 + 2];
+        auto e1x = v[vi2 * 3 + 0] - v[vi1 * 3 + 0];
+        auto e1y = v[vi2 * 3 + 1] - v[vi1 * 3 + 1];
+        auto e1z = v[vi2 * 3 + 2] - v[vi1 * 3 + 2];
+
+        auto cx = std::fabs(e0y * e1z - e0z * e1y);
+        auto cy = std::fabs(e0z * e1x - e0x * e1z);
+        auto cz = std::fabs(e0x * e1y - e0y * e1x);
+
+        constexpr auto epsilon = std::numeric_limits<float>::epsilon();
+        if (cx > epsilon || cy > epsilon || cz > epsilon) {
+            if (!(cx > cy && cx > cz)) {
+                axes[0] = 0;
+                if (cz > cx && cz > cy)
+                    axes[1] = 1;
+            }
+
+            break;
+        }
+    }
+
+    size_t guess_vert = 0;
+    size_t remaining_iterations = polygon.size();
+    size_t previous_remaining = polygon.size();
+
+    obj_index_t ind[3];
+    float vx[3];
+    float vy[3];
+
+    while (polygon.size() > 3 && remaining_iterations > 0) {
+        npolys = polygon.size();
+        if (guess_vert >= npolys)
+            guess_vert -= npolys;
+
+        if (previous_remaining != npolys) {
+            previous_remaining = npolys;
+            remaining_iterations = npolys;
+        } else {
+            remaining_iterations--;
+        }
+
+        for (size_t k = 0; k < 3; k++) {
+            ind[k] = polygon[(guess_vert + k) % npolys];
+
+            auto vi = static_cast<size_t>(ind[k].position);
+            if (vi * 3 + axes[0] >= v.size() || vi * 3 + axes[1] >= v.size()) {
+                vx[k] = 0.0f;
+                vy[k] = 0.0f;
+            } else {
+                vx[k] = v[vi * 3 + axes[0]];
+                vy[k] = v[vi * 3 + axes[1]];
+            }
+        }
+
+        auto e0x = vx[1] - vx[0];
+        auto e0y = vy[1] - vy[0];
+        auto e1x = vx[2] - vx[1];
+        auto e1y = vy[2] - vy[1];
+        auto cross = e0x * e1y - e0y * e1x;
+        auto area = (vx[0] * vy[1] - vy[0] * vx[1]) * 0.5f;
+
+        // internal angle.
+        if (cross * area < 0.0f) {
+            guess_vert += 1;
+            continue;
+        }
+
+        auto overlap = false;
+        for (size_t other = 3; other < npolys; other++) {
+            auto ovi = static_cast<size_t>(
+                polygon[(guess_vert + other) % npolys].position);
+
+            if (ovi * 3 + axes[0] >= v.size()
+                || ovi * 3 + axes[1] >= v.size()) {
+                continue;
+            }
+
+            if (point_in_triangle(
+                    vx, vy, v[ovi * 3 + axes[0]], v[ovi * 3 + axes[1]])) {
+                overlap = true;
+                break;
+            }
+        }
+
+        if (overlap) {
+            guess_vert += 1;
+            continue;
+        }
+
+        out->insert(out->end(), ind, ind + 3);
+
+        polygon.erase(polygon.begin() + (guess_vert + 1) % npolys);
+    }
+
+    if (polygon.size() == 3)
+        out->insert(out->end(), polygon.begin(), polygon.end());
+}
+
+// quads are split along their shorter diagonal.
+static bool triangulate_quad(const std::vector<float>& v,
+                             const obj_index_t* quad,
+                             std::vector<obj_index_t>* out)
+{
+    for (int32_t i = 0; i < 4; i++) {
+        if (3 * static_cast<size_t>(quad[i].position) + 2 >= v.size())
+            return false;
+    }
+
+    auto distance = [&v](const obj_index_t& a, const obj_index_t& b) {
+        auto x = v[b.position * 3 + 0] - v[a.position * 3 + 0];
+        auto y = v[b.position * 3 + 1] - v[a.position * 3 + 1];
+        auto z = v[b.position * 3 + 2] - v[a.position * 3 + 2];
+
+        return x * x + y * y + z * z;
+    };
+
+    if (distance(quad[0], quad[2]) < distance(quad[1], quad[3])) {
+        out->insert(out->end(), { quad[0], quad[1], quad[2] });
+        out->insert(out->end(), { quad[0], quad[2], quad[3] });
+    } else {
+        out->insert(out->end(), { quad[0], quad[1], quad[3] });
+        out->insert(out->end(), { quad[1], quad[2], quad[3] });
+    }
+
+    return true;
+}
+
+// `totals` are the attribute counts of the whole file.
+static void triangulate_chunk(chunk_t* chunk,
+                              const std::vector<float>& v,
+                              attribute_counts_t totals)
+{
+    std::vector<obj_index_t> polygon;
+
+    size_t offset = 0;
+    for (size_t face = 0; face < chunk->face_sizes.size(); face++) {
+        auto size = chunk->face_sizes[face];
+        auto counts = chunk->face_counts[face];
+
+        polygon.clear();
+        for (uint32_t i = 0; i < size; i++) {
+            const auto& raw = chunk->face_vertices[offset + i];
+
+            obj_index_t index {
+                .position = resolve_index(
+                    raw.position, chunk->base.positions, counts.positions),
+                .normal = resolve_index(
+                    raw.normal, chunk->base.normals, counts.normals),
+                .texcoord = resolve_index(
+                    raw.texcoord, chunk->base.texcoords, counts.texcoords),
+            };
+
+            const char* missing = nullptr;
+            if (raw.position == 0
+                || !is_valid_index(
+                    raw.position, index.position, totals.positions)) {
+                missing = "position";
+            } else if (!is_valid_index(
+                           raw.normal, index.normal, totals.normals)) {
+                missing = "normal";
+            } else if (!is_valid_index(
+                           raw.texcoord, index.texcoord, totals.texcoords)) {
+                missing = "texcoord";
+            }
+
+            if (missing) {
+                chunk->error = std::format(
+                    "line {}: face references a {} that doesn't exist",
+                    chunk->first_line + chunk->face_lines[face],
+                    missing);
+                return;
+            }
+
+            polygon.push_back(index);
+        }
+
+        offset += size;
+
+        auto material = chunk->face_materials[face];
+        material = material == INHERITED_MATERIAL
+            ? chunk->inherited_material
+            : chunk->material_ids[material];
+
+        auto triangles = chunk->indices.size();
+
+        if (size < 3) {
+            chunk->warning += "degenerate face found\n";
+            continue;
+        } else if (size == 3) {
+            chunk->indices.insert(
+                chunk->indices.end(), polygon.begin(), polygon.end());
+        } else if (size == 4) {
+            if (!triangulate_quad(v, polygon.data(), &chunk->indices)) {
+                chunk->warning += "face with invalid vertex index found\n";
+                continue;
+            }
+        } else {
+            triangulate_polygon(v, polygon, &chunk->indices);
+        }
+
+        triangles = (chunk->indices.size() - triangles) / 3;
+        chunk->triangle_materials.insert(
+            chunk->triangle_materials.end(), triangles, material);
+    }
+}
+
+static void load_materials(const fs::path& directory,
+                           const std::string& libraries,
+                           obj_data_t* data,
+                           std::map<std::string, int32_t>* material_map)
+{
+    // the first library of the line that can be read is used.
+    std::string_view line = libraries;
+    auto it = line.data();
+    auto end = it + line.size();
+
+    while (true) {
+        auto name = parse_word(&it, end);
+        if (name.empty())
+            break;
+
+        resource_file_t file;
+        if (!file.open(directory / name))
+            continue;
+
+        auto bytes = file.get_data();
+        std::ispanstream stream(std::span(
+            reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+
+        tinyobj::MaterialStreamReader reader(stream);
+
+        std::string warning, error;
+        if (reader(std::string(name),
+                   &data->materials,
+                   material_map,
+                   &warning,
+                   &error)) {
+            data->warning += warning;
+            return;
+        }
+    }
+
+    data->warning += std::format("can't read material library '{}'\n", line);
+}
+
+std::expected<obj_data_t, std::string> parse_obj(const fs::path& path)
+{
+    resource_file_t file;
+    if (auto result = file.open(path); !result)
+        return std::unexpected(result.error());
+
+    auto bytes = file.get_data();
+    std::string_view text(reinterpret_cast<const char*>(bytes.data()),
+                          bytes.size());
+
+    size_t chunk_count
+        = std::clamp<size_t>(text.size() / MIN_CHUNK_SIZE,
+                             1,
+                             std::max(1u, std::thread::hardware_concurrency()));
+
+    std::vector<chunk_t> chunks(chunk_count);
+
+    // split at the first line break after every even division.
+    size_t begin = 0;
+    for (size_t i = 0; i < chunk_count; i++) {
+        auto end = i + 1 == chunk_count ? text.size()
+                                        : text.size() * (i + 1) / chunk_count;
+
+        end = std::max(end, begin);
+        if (end < text.size()) {
+            end = text.find('\n', end);
+            end = end == text.npos ? text.size() : end + 1;
+        }
+
+        chunks[i].text = text.substr(begin, end - begin);
+        begin = end;
+    }
+
+    run_parallel(chunk_count, [&chunks](size_t i) { parse_chunk(&chunks[i]); });
+
+    obj_data_t data;
+    std::map<std::string, int32_t> material_map;
+
+    for (const auto& chunk : chunks) {
+        for (const auto& libraries : chunk.material_libraries)
+            load_materials(path.parent_path(), libraries, &data, &material_map);
+    }
+
+    // attribute offsets and the material current at the start of each chunk.
+    attribute_counts_t base {};
+    uint32_t line = 0;
+    int32_t material = -1;
+
+    for (auto& chunk : chunks) {
+        chunk.base = base;
+        chunk.first_line = line;
+        chunk.inherited_material = material;
+
+        line += chunk.line_count;
+
+        base.positions += chunk.positions.size() / 3;
+        base.normals += chunk.normals.size() / 3;
+        base.texcoords += chunk.texcoords.size() / 2;
+
+        for (const auto& name : chunk.material_names) {
+            auto it = material_map.find(name);
+            if (it == material_map.end()) {
+                data.warning += std::format(
+                    "material '{}' not found in the material libraries\n",
+                    name);
+            }
+
+            chunk.material_ids.push_back(it != material_map.end() ? it->second
+                                                                  : -1);
+        }
+
+        if (!chunk.material_ids.empty())
+            material = chunk.material_ids.back();
+
+        data.positions.insert(data.positions.end(),
+                              chunk.positions.begin(),
+                              chunk.positions.end());
+        data.normals.insert(
+            data.normals.end(), chunk.normals.begin(), chunk.normals.end());
+        data.texcoords.insert(data.texcoords.end(),
+                              chunk.texcoords.begin(),
+                              chunk.texcoords.end());
+    }
+
+    run_parallel(chunk_count, [&chunks, &data, base](size_t i) {
+        triangulate_chunk(&chunks[i], data.positions, base);
+    });
+
+    for (const auto& chunk : chunks) {
+        if (!chunk.error.empty()) {
+            return std::unexpected(
+                std::format("'{}': {}", path.string(), chunk.error));
+        }
+    }
+
+    for (const auto& chunk : chunks) {
+        data.indices.insert(
+            data.indices.end(), chunk.indices.begin(), chunk.indices.end());
+        data.material_ids.insert(data.material_ids.end(),
+                                 chunk.triangle_materials.begin(),
+                                 chunk.triangle_materials.end());
+        data.warning += chunk.warning;
+    }
+
+    return data;
+}
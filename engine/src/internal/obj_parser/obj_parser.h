@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <tiny_obj_loader.h>
+
+namespace fs = std::filesystem;
+
+// indices into the attribute arrays of `obj_data_t`, -1 when the face vertex
+// doesn't reference the attribute.
+struct obj_index_t {
+    int32_t position;
+    int32_t normal;
+    int32_t texcoord;
+};
+
+// triangulated contents of an .obj file, faces are kept in file order.
+// polygons are split the same way tinyobjloader splits them.
+struct obj_data_t {
+    std::vector<float> positions;
+    std::vector<float> normals;
+    std::vector<float> texcoords;
+
+    // three per triangle.
+    std::vector<obj_index_t> indices;
+
+    // one per triangle, -1 for faces without a known material.
+    std::vector<int32_t> material_ids;
+
+    std::vector<tinyobj::material_t> materials;
+
+    std::string warning;
+};
+
+// maps the file and parses it in chunks split at line boundaries, one worker
+// thread per chunk. materials are read with tinyobjloader.
+std::expected<obj_data_t, std::string> parse_obj(const fs::path& path);
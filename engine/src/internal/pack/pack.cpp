@@ -0,0 +1,500 @@
+#include "pack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <fstream>
+
+#include <resource_pack.h>
+
+static constexpr char PACK_MAGIC[8] = {
+    'F', 'E', 'R', 'E', 'S', 'P', 'A', 'K'
+};
+
+struct pack_header_t {
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_count;
+    uint64_t names_size;
+};
+
+// lz4 block format: every sequence is a token with the literal length in the
+// high and the match length in the low nibble, the literals, a 16-bit offset
+// and the rest of the match length. the last sequence has no match, and the
+// last bytes of the block are always literals.
+static constexpr size_t LZ_MIN_MATCH = 4;
+static constexpr size_t LZ_LAST_LITERALS = 5;
+static constexpr size_t LZ_MATCH_LIMIT = 12;
+static constexpr size_t LZ_MAX_OFFSET = 65535;
+static constexpr uint32_t LZ_HASH_BITS = 14;
+
+static pack_t s_mounted;
+
+static uint64_t hash_name(std::string_view name)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (auto c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+static uint64_t align_offset(uint64_t offset)
+{
+    auto mask = pack_t::PACK_ALIGNMENT - 1;
+    return (offset + mask) & ~mask;
+}
+
+static void lz_write_length(std::vector<std::byte>* out, size_t length)
+{
+    for (; length >= 255; length -= 255)
+        out->push_back(std::byte { 255 });
+
+    out->push_back(static_cast<std::byte>(length));
+}
+
+// a zero `match_length` writes the last sequence of the block.
+static void lz_write_sequence(std::vector<std::byte>* out,
+                              std::span<const uint8_t> literals,
+                              size_t match_length,
+                              size_t offset)
+{
+    auto literal_length = literals.size();
+    auto match_code = match_length ? match_length - LZ_MIN_MATCH : 0;
+
+    auto token = std::min<size_t>(literal_length, 15) << 4
+               | std::min<size_t>(match_code, 15);
+    out->push_back(static_cast<std::byte>(token));
+
+    if (literal_length >= 15)
+        lz_write_length(out, literal_length - 15);
+
+    auto bytes = std::as_bytes(literals);
+    out->insert(out->end(), bytes.begin(), bytes.end());
+
+    if (!match_length)
+        return;
+
+    out->push_back(static_cast<std::byte>(offset & 0xff));
+    out->push_back(static_cast<std::byte>(offset >> 8));
+
+    if (match_code >= 15)
+        lz_write_length(out, match_code - 15);
+}
+
+static std::vector<std::byte> lz_compress(std::span<const std::byte> source)
+{
+    auto data = reinterpret_cast<const uint8_t*>(source.data());
+    auto size = source.size();
+
+    std::vector<std::byte> out;
+    out.reserve(size + size / 255 + 16);
+
+    // the last position seen for each hash of four bytes.
+    std::vector<uint32_t> table(1u << LZ_HASH_BITS, UINT32_MAX);
+
+    size_t anchor = 0;
+    size_t i = 0;
+
+    while (size > LZ_MATCH_LIMIT && i < size - LZ_MATCH_LIMIT) {
+        uint32_t sequence;
+        std::memcpy(&sequence, data + i, sizeof(sequence));
+
+        auto hash = (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+        size_t candidate = table[hash];
+        table[hash] = static_cast<uint32_t>(i);
+
+        if (candidate == UINT32_MAX || i - candidate > LZ_MAX_OFFSET
+            || std::memcmp(data + candidate, data + i, LZ_MIN_MATCH)) {
+            i++;
+            continue;
+        }
+
+        while (i > anchor && candidate > 0
+               && data[i - 1] == data[candidate - 1]) {
+            i--;
+            candidate--;
+        }
+
+        auto length = LZ_MIN_MATCH;
+        while (i + length < size - LZ_LAST_LITERALS
+               && data[i + length] == data[candidate + length]) {
+            length++;
+        }
+
+        lz_write_sequence(
+            &out, { data + anchor, data + i }, length, i - candidate);
+
+        i += length;
+        anchor = i;
+    }
+
+    lz_write_sequence(&out, { data + anchor, data + size }, 0, 0);
+
+    return out;
+}
+
+static bool lz_read_length(std::span<const std::byte> source,
+                           size_t* in,
+                           size_t* length)
+{
+    uint8_t byte;
+    do {
+        if (*in >= source.size())
+            return false;
+
+        byte = static_cast<uint8_t>(source[(*in)++]);
+        *length += byte;
+    } while (byte == 255);
+
+    return true;
+}
+
+// fails on malformed input instead of reading or writing out of bounds.
+static bool lz_decompress(std::span<const std::byte> source,
+                          std::span<std::byte> destination)
+{
+    size_t in = 0;
+    size_t out = 0;
+
+    while (in < source.size()) {
+        auto token = static_cast<uint8_t>(source[in++]);
+
+        size_t literal_length = token >> 4;
+        if (literal_length == 15
+            && !lz_read_length(source, &in, &literal_length)) {
+            return false;
+        }
+
+        if (literal_length > source.size() - in
+            || literal_length > destination.size() - out) {
+            return false;
+        }
+
+        std::memcpy(
+            destination.data() + out, source.data() + in, literal_length);
+        in += literal_length;
+        out += literal_length;
+
+        if (in == source.size())
+            break;
+
+        if (source.size() - in < 2)
+            return false;
+
+        size_t offset = static_cast<uint8_t>(source[in])
+                      | static_cast<uint8_t>(source[in + 1]) << 8;
+        in += 2;
+
+        size_t match_length = token & 15;
+        if (match_length == 15 && !lz_read_length(source, &in, &match_length))
+            return false;
+
+        match_length += LZ_MIN_MATCH;
+
+        if (offset == 0 || offset > out
+            || match_length > destination.size() - out) {
+            return false;
+        }
+
+        // the match may overlap the bytes it produces.
+        for (size_t j = 0; j < match_length; j++, out++)
+            destination[out] = destination[out - offset];
+    }
+
+    return out == destination.size();
+}
+
+std::string make_pack_name(const fs::path& path)
+{
+    return path.lexically_normal().generic_string();
+}
+
+std::expected<void, std::string>
+write_pack(std::span<const pack_source_t> sources,
+           const fs::path& destination,
+           bool compress)
+{
+    std::vector<pack_entry_t> entries;
+    std::vector<std::vector<std::byte>> contents;
+    std::string names;
+
+    for (const auto& source : sources) {
+        mapped_file_t file;
+        if (auto result = file.open(source.path); !result)
+            return result;
+
+        auto data = file.get_data();
+
+        pack_entry_t entry {
+            .hash = hash_name(source.name),
+            .size = data.size(),
+            .original_size = data.size(),
+            .name_offset = static_cast<uint32_t>(names.size()),
+            .name_size = static_cast<uint32_t>(source.name.size()),
+            .compression = pack_compression_t::none,
+        };
+
+        std::vector<std::byte> content(data.begin(), data.end());
+
+        // entries that barely shrink are cheaper to map than to decompress.
+        if (compress && !data.empty()) {
+            auto compressed = lz_compress(data);
+            if (compressed.size() < data.size() - data.size() / 8) {
+                entry.size = compressed.size();
+                entry.compression = pack_compression_t::lz;
+                content = std::move(compressed);
+            }
+        }
+
+        names += source.name;
+        entries.push_back(entry);
+        contents.push_back(std::move(content));
+    }
+
+    std::vector<uint32_t> order(entries.size());
+    for (uint32_t i = 0; i < order.size(); i++)
+        order[i] = i;
+
+    auto get_name = [&names](const pack_entry_t& entry) {
+        return std::string_view(names).substr(entry.name_offset,
+                                              entry.name_size);
+    };
+
+    std::ranges::sort(order, [&](uint32_t a, uint32_t b) {
+        if (entries[a].hash != entries[b].hash)
+            return entries[a].hash < entries[b].hash;
+
+        return get_name(entries[a]) < get_name(entries[b]);
+    });
+
+    for (size_t i = 1; i < order.size(); i++) {
+        const auto& entry = entries[order[i]];
+        if (entry.hash == entries[order[i - 1]].hash
+            && get_name(entry) == get_name(entries[order[i - 1]])) {
+            return std::unexpected(std::format(
+                "'{}' is added to the pack twice", get_name(entry)));
+        }
+    }
+
+    auto offset = align_offset(sizeof(pack_header_t)
+                               + entries.size() * sizeof(pack_entry_t)
+                               + names.size());
+
+    std::vector<pack_entry_t> index;
+    for (auto i : order) {
+        entries[i].offset = offset;
+        offset = align_offset(offset + entries[i].size);
+
+        index.push_back(entries[i]);
+    }
+
+    std::ofstream stream(destination, std::ios::binary | std::ios::trunc);
+
+    pack_header_t header {
+        .version = pack_t::VERSION,
+        .entry_count = static_cast<uint32_t>(index.size()),
+        .names_size = names.size(),
+    };
+    std::memcpy(header.magic, PACK_MAGIC, sizeof(header.magic));
+
+    auto write = [&stream](const void* data, size_t size) {
+        stream.write(static_cast<const char*>(data), size);
+    };
+
+    auto pad = [&stream]() {
+        auto position = static_cast<uint64_t>(stream.tellp());
+        for (auto i = position; i < align_offset(position); i++)
+            stream.put('\0');
+    };
+
+    write(&header, sizeof(header));
+    write(index.data(), index.size() * sizeof(pack_entry_t));
+    write(names.data(), names.size());
+
+    for (auto i : order) {
+        pad();
+        write(contents[i].data(), contents[i].size());
+    }
+
+    if (!stream.good()) {
+        return std::unexpected(
+            std::format("failed to write pack '{}'", destination.string()));
+    }
+
+    return {};
+}
+
+std::expected<void, std::string> pack_t::open(const fs::path& path)
+{
+    close();
+
+    if (auto result = m_file.open(path); !result)
+        return result;
+
+    auto data = m_file.get_data();
+
+    pack_header_t header;
+    if (data.size() < sizeof(header)) {
+        close();
+        return std::unexpected(
+            std::format("'{}' is not a resource pack", path.string()));
+    }
+
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, PACK_MAGIC, sizeof(header.magic))) {
+        close();
+        return std::unexpected(
+            std::format("'{}' is not a resource pack", path.string()));
+    }
+
+    if (header.version != VERSION) {
+        close();
+        return std::unexpected(
+            std::format("'{}': unsupported pack version {}, expected {}",
+                        path.string(),
+                        header.version,
+                        VERSION));
+    }
+
+    auto index_size = header.entry_count * sizeof(pack_entry_t);
+    if (data.size() - sizeof(header) < index_size
+        || data.size() - sizeof(header) - index_size < header.names_size) {
+        close();
+        return std::unexpected(
+            std::format("'{}': pack is truncated", path.string()));
+    }
+
+    m_entries.resize(header.entry_count);
+    std::memcpy(m_entries.data(), data.data() + sizeof(header), index_size);
+
+    m_names = std::string_view(
+        reinterpret_cast<const char*>(data.data()) + sizeof(header)
+            + index_size,
+        header.names_size);
+
+    for (size_t i = 0; i < m_entries.size(); i++) {
+        const auto& entry = m_entries[i];
+
+        bool valid = entry.offset <= data.size()
+                  && entry.size <= data.size() - entry.offset
+                  && entry.name_offset <= m_names.size()
+                  && entry.name_size <= m_names.size() - entry.name_offset
+                  && (i == 0 || m_entries[i - 1].hash <= entry.hash);
+
+        if (entry.compression == pack_compression_t::none)
+            valid = valid && entry.size == entry.original_size;
+        else
+            valid = valid && entry.compression == pack_compression_t::lz;
+
+        if (!valid) {
+            close();
+            return std::unexpected(
+                std::format("'{}': pack index is corrupted", path.string()));
+        }
+    }
+
+    m_path = path;
+
+    return {};
+}
+
+void pack_t::close()
+{
+    m_file.close();
+    m_entries.clear();
+    m_names = {};
+    m_path.clear();
+}
+
+bool pack_t::is_open() const
+{
+    return !m_path.empty();
+}
+
+const pack_entry_t* pack_t::find(std::string_view name) const
+{
+    auto hash = hash_name(name);
+
+    auto it
+        = std::ranges::lower_bound(m_entries, hash, {}, &pack_entry_t::hash);
+
+    for (; it != m_entries.end() && it->hash == hash; it++) {
+        if (m_names.substr(it->name_offset, it->name_size) == name)
+            return &*it;
+    }
+
+    return nullptr;
+}
+
+std::span<const std::byte> pack_t::get_data(const pack_entry_t& entry) const
+{
+    return m_file.get_data().subspan(entry.offset, entry.size);
+}
+
+std::expected<void, std::string>
+pack_t::decompress(const pack_entry_t& entry, std::vector<std::byte>* out) const
+{
+    out->resize(entry.original_size);
+
+    if (!lz_decompress(get_data(entry), *out)) {
+        return std::unexpected(std::format(
+            "'{}': entry '{}' is corrupted",
+            m_path.string(),
+            m_names.substr(entry.name_offset, entry.name_size)));
+    }
+
+    return {};
+}
+
+std::expected<void, std::string> resource_file_t::open(const fs::path& path)
+{
+    m_file.close();
+    m_buffer.clear();
+    m_data = {};
+
+    auto entry = s_mounted.is_open() ? s_mounted.find(make_pack_name(path))
+                                     : nullptr;
+
+    if (!entry) {
+        if (auto result = m_file.open(path); !result)
+            return result;
+
+        m_data = m_file.get_data();
+        return {};
+    }
+
+    if (entry->compression == pack_compression_t::none) {
+        m_data = s_mounted.get_data(*entry);
+        return {};
+    }
+
+    if (auto result = s_mounted.decompress(*entry, &m_buffer); !result)
+        return result;
+
+    m_data = m_buffer;
+    return {};
+}
+
+std::span<const std::byte> resource_file_t::get_data() const
+{
+    return m_data;
+}
+
+bool resource_file_t::is_packed(const fs::path& path)
+{
+    return s_mounted.is_open() && s_mounted.find(make_pack_name(path));
+}
+
+std::expected<void, std::string> mount_resource_pack(const fs::path& path)
+{
+    return s_mounted.open(path);
+}
+
+void unmount_resource_pack()
+{
+    s_mounted.close();
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <mapped_file/mapped_file.h>
+
+namespace fs = std::filesystem;
+
+enum class pack_compression_t : uint32_t {
+    none,
+
+    // the lz4 block format.
+    lz,
+};
+
+struct pack_entry_t {
+    // fnv-1a of the name, the index is sorted by it.
+    uint64_t hash;
+
+    // where the stored bytes start, a multiple of `PACK_ALIGNMENT`.
+    uint64_t offset;
+    uint64_t size;
+    uint64_t original_size;
+
+    uint32_t name_offset;
+    uint32_t name_size;
+
+    pack_compression_t compression;
+    uint32_t padding;
+};
+
+struct pack_source_t {
+    // the name the file is looked up with, see `make_pack_name`.
+    std::string name;
+    fs::path path;
+};
+
+// the name of `path` inside a pack, a normalized relative path with forward
+// slashes.
+std::string make_pack_name(const fs::path& path);
+
+// writes `sources` to a pack at `destination`. with `compress` every entry
+// that gets noticeably smaller is stored compressed, the others stay
+// uncompressed so they can still be read without a copy.
+std::expected<void, std::string>
+write_pack(std::span<const pack_source_t> sources,
+           const fs::path& destination,
+           bool compress);
+
+// a mapped pack. the header is followed by the index and the names, every
+// entry starts aligned to `PACK_ALIGNMENT` so the mapped bytes can be used
+// in place.
+class pack_t {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint64_t PACK_ALIGNMENT = 64;
+
+    pack_t() = default;
+
+    pack_t(const pack_t& other) = delete;
+    pack_t& operator=(const pack_t& other) = delete;
+
+    std::expected<void, std::string> open(const fs::path& path);
+
+    void close();
+
+    bool is_open() const;
+
+    // null if the pack has no entry called `name`.
+    const pack_entry_t* find(std::string_view name) const;
+
+    // the bytes of `entry` as stored in the pack, compressed or not.
+    std::span<const std::byte> get_data(const pack_entry_t& entry) const;
+
+    // decompresses `entry` into `out`, which is resized to fit.
+    std::expected<void, std::string>
+    decompress(const pack_entry_t& entry, std::vector<std::byte>* out) const;
+
+private:
+    fs::path m_path;
+    mapped_file_t m_file;
+
+    std::vector<pack_entry_t> m_entries;
+    std::string_view m_names;
+};
+
+// a file read through the mounted resource pack, or a mapped loose file if
+// the pack has no entry for it. uncompressed entries are views into the
+// pack, compressed ones are decompressed into a buffer the file owns.
+class resource_file_t {
+public:
+    std::expected<void, std::string> open(const fs::path& path);
+
+    std::span<const std::byte> get_data() const;
+
+    // whether the mounted pack has an entry for `path`.
+    static bool is_packed(const fs::path& path);
+
+private:
+    mapped_file_t m_file;
+    std::vector<std::byte> m_buffer;
+    std::span<const std::byte> m_data;
+};
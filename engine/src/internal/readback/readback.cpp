@@ -0,0 +1,205 @@
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+
+#include <memory_stats.h>
+
+#include "readback.h"
+
+static int64_t get_frame_size(int32_t width, int32_t height)
+{
+    return static_cast<int64_t>(width) * height * 4;
+}
+
+std::expected<void, std::string> readback_ring_t::init(
+    int32_t width, int32_t height, frame_capture_settings_t settings)
+{
+    m_width = width;
+    m_height = height;
+    m_settings = std::move(settings);
+    m_settings.interval = std::max(m_settings.interval, 1u);
+
+    glGenRenderbuffers(1, &m_color);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_color);
+
+    auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        glDeleteFramebuffers(1, &m_framebuffer);
+        glDeleteRenderbuffers(1, &m_color);
+
+        return std::unexpected(std::format(
+            "capture framebuffer is incomplete, status {:#x}", status));
+    }
+
+    auto size = get_frame_size(width, height);
+
+    for (auto& slot : m_slots) {
+        glGenBuffers(1, &slot.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    memory_tracker_t::track_gpu(memory_tracker_t::GPU_TEXTURE_SCOPE, size);
+    memory_tracker_t::track_gpu(memory_tracker_t::GPU_BUFFER_SCOPE,
+                                size * RING_SIZE);
+
+    m_worker = std::thread([this]() { run_worker(); });
+
+    return {};
+}
+
+void readback_ring_t::destroy()
+{
+    for (uint32_t i = 0; i < RING_SIZE; i++)
+        collect(&m_slots[(m_next + i) % RING_SIZE], true);
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_wake.notify_one();
+
+    if (m_worker.joinable())
+        m_worker.join();
+
+    auto size = get_frame_size(m_width, m_height);
+
+    for (auto& slot : m_slots)
+        glDeleteBuffers(1, &slot.pbo);
+
+    glDeleteFramebuffers(1, &m_framebuffer);
+    glDeleteRenderbuffers(1, &m_color);
+
+    memory_tracker_t::track_gpu(memory_tracker_t::GPU_TEXTURE_SCOPE, -size);
+    memory_tracker_t::track_gpu(memory_tracker_t::GPU_BUFFER_SCOPE,
+                                -size * RING_SIZE);
+}
+
+void readback_ring_t::bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+}
+
+void readback_ring_t::end_frame()
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0,
+                      0,
+                      m_width,
+                      m_height,
+                      0,
+                      0,
+                      m_width,
+                      m_height,
+                      GL_COLOR_BUFFER_BIT,
+                      GL_NEAREST);
+
+    // copies finish in order, stop at the first one still running.
+    for (uint32_t i = 0; i < RING_SIZE; i++) {
+        if (!collect(&m_slots[(m_next + i) % RING_SIZE], false))
+            break;
+    }
+
+    auto frame = m_frame++;
+
+    if (frame % m_settings.interval == 0) {
+        auto& slot = m_slots[m_next];
+
+        // every slot is in flight, the oldest copy has to finish first.
+        collect(&slot, true);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glReadPixels(
+            0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot.frame = frame;
+
+        m_next = (m_next + 1) % RING_SIZE;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+bool readback_ring_t::collect(slot_t* slot, bool wait)
+{
+    if (!slot->fence)
+        return true;
+
+    auto fence = static_cast<GLsync>(slot->fence);
+
+    auto status = glClientWaitSync(fence,
+                                   wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                   wait ? GL_TIMEOUT_IGNORED : 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+        return false;
+
+    glDeleteSync(fence);
+    slot->fence = nullptr;
+
+    if (status == GL_WAIT_FAILED)
+        return true;
+
+    auto size = get_frame_size(m_width, m_height);
+
+    captured_frame_t frame {
+        .frame = slot->frame,
+        .width = m_width,
+        .height = m_height,
+        .pixels = std::vector<uint8_t>(size),
+    };
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+    if (auto pixels = glMapBufferRange(
+            GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT)) {
+        std::memcpy(frame.pixels.data(), pixels, size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_frames.push_back(std::move(frame));
+    }
+
+    m_wake.notify_one();
+    return true;
+}
+
+void readback_ring_t::run_worker()
+{
+    while (true) {
+        captured_frame_t frame;
+
+        {
+            std::unique_lock lock(m_mutex);
+            m_wake.wait(
+                lock, [this]() { return m_stopping || !m_frames.empty(); });
+
+            // frames queued before `destroy` are still handed out.
+            if (m_frames.empty())
+                return;
+
+            frame = std::move(m_frames.front());
+            m_frames.pop_front();
+        }
+
+        m_settings.on_frame(std::move(frame));
+    }
+}
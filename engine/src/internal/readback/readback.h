@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <frame_capture.h>
+
+// renders into an offscreen framebuffer and reads frames back through a ring
+// of pixel buffer objects. the copy of a frame is only mapped once its fence
+// has signaled, usually a frame or two later, so the cpu never waits for the
+// gpu unless every buffer of the ring is still in flight. the pixels are
+// handed to a worker thread that calls `on_frame`.
+class readback_ring_t {
+public:
+    static constexpr uint32_t RING_SIZE = 3;
+
+    readback_ring_t() = default;
+
+    readback_ring_t(const readback_ring_t& other) = delete;
+    readback_ring_t& operator=(const readback_ring_t& other) = delete;
+
+    std::expected<void, std::string>
+    init(int32_t width, int32_t height, frame_capture_settings_t settings);
+
+    // reads back the frames still in flight and waits until the worker
+    // handed out every frame.
+    void destroy();
+
+    // makes the offscreen framebuffer the render target.
+    void bind() const;
+
+    // copies the frame to the window and queues its readback.
+    void end_frame();
+
+private:
+    struct slot_t {
+        uint32_t pbo { 0 };
+
+        // the `GLsync` of the copy, null while the slot is free.
+        void* fence { nullptr };
+
+        uint64_t frame { 0 };
+    };
+
+    // hands the pixels of `slot` to the worker once its copy has finished,
+    // or right away with `wait`. returns false if the copy is still running.
+    bool collect(slot_t* slot, bool wait);
+
+    void run_worker();
+
+private:
+    uint32_t m_framebuffer { 0 };
+    uint32_t m_color { 0 };
+
+    int32_t m_width { 0 };
+    int32_t m_height { 0 };
+
+    std::array<slot_t, RING_SIZE> m_slots {};
+
+    // the oldest slot in flight, and the next one to use.
+    uint32_t m_next { 0 };
+    uint64_t m_frame { 0 };
+
+    frame_capture_settings_t m_settings;
+
+    std::thread m_worker;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<captured_frame_t> m_frames;
+    bool m_stopping { false };
+};
@@ -1,15 +1,18 @@
 #include "shader.h"
 
 #include <glad/glad.h>
+#include <array>
+#include <cstddef>
 #include <cstring>
 #include <expected>
 #include <filesystem>
-#include <fstream>
 #include <print>
-#include <sstream>
 #include <string>
 #include <string_view>
 
+#include <frame_uniforms/frame_uniforms.h>
+#include <pack/pack.h>
+
 shader_t::~shader_t()
 {
     if (m_program != 0)
@@ -35,27 +38,84 @@ void shader_t::bind() const
     glUseProgram(m_program);
 }
 
-std::expected<void, std::string>
-shader_t::load_shader(const fs::path& shader_source_path)
+struct frame_member_t {
+    const char* name;
+    size_t offset;
+};
+
+static constexpr std::array<frame_member_t, 6> FRAME_MEMBERS = { {
+    { "u_projection", offsetof(frame_uniforms_t, projection) },
+    { "u_view", offsetof(frame_uniforms_t, view) },
+    { "u_view_projection", offsetof(frame_uniforms_t, view_projection) },
+    { "u_viewport", offsetof(frame_uniforms_t, viewport) },
+    { "u_time", offsetof(frame_uniforms_t, time) },
+    { "u_delta_time", offsetof(frame_uniforms_t, delta_time) },
+} };
+
+// std140 blocks and their members are always active, so a block the program
+// declares is found even if no stage reads it.
+static std::expected<void, std::string> bind_frame_uniforms(uint32_t program)
 {
-    if (!fs::exists(shader_source_path)) {
+    auto block
+        = glGetUniformBlockIndex(program, frame_uniform_buffer_t::BLOCK_NAME);
+
+    if (block == GL_INVALID_INDEX) {
         return std::unexpected(
-            std::format("can't read a non-existent shader file '{}'",
-                        shader_source_path.c_str()));
+            std::format("program doesn't declare the '{}' uniform block",
+                        frame_uniform_buffer_t::BLOCK_NAME));
     }
 
-    std::ifstream stream(shader_source_path);
+    int32_t size = 0;
+    glGetActiveUniformBlockiv(
+        program, block, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
 
-    if (!stream) {
-        return std::unexpected(std::format("can't read a shader file '{}'",
-                                           shader_source_path.c_str()));
+    // the reported size is the smallest buffer the block needs, a driver may
+    // leave out the trailing padding.
+    if (size > static_cast<int32_t>(sizeof(frame_uniforms_t))) {
+        return std::unexpected(
+            std::format("'{}' uniform block is {} bytes, expected at most {}",
+                        frame_uniform_buffer_t::BLOCK_NAME,
+                        size,
+                        sizeof(frame_uniforms_t)));
+    }
+
+    for (const auto& member : FRAME_MEMBERS) {
+        uint32_t index = GL_INVALID_INDEX;
+        glGetUniformIndices(program, 1, &member.name, &index);
+
+        int32_t offset = -1;
+        if (index != GL_INVALID_INDEX) {
+            glGetActiveUniformsiv(
+                program, 1, &index, GL_UNIFORM_OFFSET, &offset);
+        }
+
+        if (offset != static_cast<int32_t>(member.offset)) {
+            return std::unexpected(
+                std::format("'{}' uniform block doesn't match "
+                            "frame_uniforms_t at '{}'",
+                            frame_uniform_buffer_t::BLOCK_NAME,
+                            member.name));
+        }
     }
 
-    std::stringstream ss;
-    ss << stream.rdbuf();
+    glUniformBlockBinding(program, block, frame_uniform_buffer_t::BINDING);
+
+    return {};
+}
+
+std::expected<void, std::string>
+shader_t::load_shader(const fs::path& shader_source_path)
+{
+    resource_file_t file;
+    if (auto result = file.open(shader_source_path); !result) {
+        return std::unexpected(std::format("can't read a shader file '{}': {}",
+                                           shader_source_path.c_str(),
+                                           result.error()));
+    }
 
-    std::string file_content = ss.str();
-    std::string_view source = file_content;
+    auto bytes = file.get_data();
+    std::string_view source(reinterpret_cast<const char*>(bytes.data()),
+                            bytes.size());
 
     if (!source.starts_with("#version")) {
         return std::unexpected(std::format(
@@ -164,6 +224,12 @@ shader_t::load_shader(const fs::path& shader_source_path)
     glDeleteShader(vshader);
     glDeleteShader(fshader);
 
+    if (auto result = bind_frame_uniforms(program); !result) {
+        glDeleteProgram(program);
+        return std::unexpected(std::format(
+            "({}): {}", shader_source_path.c_str(), result.error()));
+    }
+
     m_program = program;
 
     return {};
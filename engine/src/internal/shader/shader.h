@@ -21,6 +21,8 @@ public:
 
     void bind() const;
 
+    // the program has to declare the `frame_data` block of `frame_uniforms_t`,
+    // it is bound to the shared frame uniform buffer.
     std::expected<void, std::string>
     load_shader(const fs::path& shader_source_path);
 
@@ -0,0 +1,383 @@
+#include <glad/glad.h>
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <fstream>
+
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
+#include <memory_stats.h>
+
+#include "texture.h"
+
+static constexpr uint32_t TEXTURE_VERSION = 1;
+static constexpr size_t MIP_ALIGNMENT = 64;
+
+static constexpr char TEXTURE_MAGIC[8] = {
+    'F', 'E', 'T', 'E', 'X', 0, 0, 0
+};
+
+static size_t align_mip(size_t offset)
+{
+    return (offset + MIP_ALIGNMENT - 1) & ~(MIP_ALIGNMENT - 1);
+}
+
+static uint8_t average(const uint8_t* a,
+                       const uint8_t* b,
+                       const uint8_t* c,
+                       const uint8_t* d)
+{
+    return static_cast<uint8_t>((*a + *b + *c + *d + 2) >> 2);
+}
+
+#ifdef __SSE2__
+
+// averages the 2x2 blocks of 8 source pixels from two rows into 4 destination
+// pixels.
+static void downsample_block(const uint8_t* row0,
+                             const uint8_t* row1,
+                             uint8_t* dst)
+{
+    auto zero = _mm_setzero_si128();
+    auto bias = _mm_set1_epi16(2);
+
+    auto sum_pairs = [zero](__m128i top, __m128i bottom) {
+        auto lo = _mm_add_epi16(_mm_unpacklo_epi8(top, zero),
+                                _mm_unpacklo_epi8(bottom, zero));
+        auto hi = _mm_add_epi16(_mm_unpackhi_epi8(top, zero),
+                                _mm_unpackhi_epi8(bottom, zero));
+
+        // lanes 0-3 hold pixel 0 and lanes 4-7 pixel 1 of each half, add the
+        // two pixels of every half together.
+        lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+        hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+
+        return _mm_unpacklo_epi64(lo, hi);
+    };
+
+    auto top0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0));
+    auto top1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 16));
+    auto bottom0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1));
+    auto bottom1
+        = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 16));
+
+    auto first = _mm_srli_epi16(
+        _mm_add_epi16(sum_pairs(top0, bottom0), bias), 2);
+    auto second = _mm_srli_epi16(
+        _mm_add_epi16(sum_pairs(top1, bottom1), bias), 2);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                     _mm_packus_epi16(first, second));
+}
+
+#endif
+
+// box filters an rgba8 image down to half its size, odd edges are clamped.
+static void downsample(const uint8_t* src,
+                       uint32_t src_width,
+                       uint32_t src_height,
+                       uint8_t* dst,
+                       uint32_t dst_width,
+                       uint32_t dst_height)
+{
+    for (uint32_t y = 0; y < dst_height; y++) {
+        auto y0 = std::min(y * 2, src_height - 1);
+        auto y1 = std::min(y * 2 + 1, src_height - 1);
+
+        auto row0 = src + static_cast<size_t>(y0) * src_width * 4;
+        auto row1 = src + static_cast<size_t>(y1) * src_width * 4;
+        auto out = dst + static_cast<size_t>(y) * dst_width * 4;
+
+        uint32_t x = 0;
+
+#ifdef __SSE2__
+        for (; (x + 4) * 2 <= src_width; x += 4)
+            downsample_block(row0 + x * 8, row1 + x * 8, out + x * 4);
+#endif
+
+        for (; x < dst_width; x++) {
+            auto x0 = std::min(x * 2, src_width - 1) * 4;
+            auto x1 = std::min(x * 2 + 1, src_width - 1) * 4;
+
+            for (uint32_t c = 0; c < 4; c++) {
+                out[x * 4 + c] = average(row0 + x0 + c,
+                                         row0 + x1 + c,
+                                         row1 + x0 + c,
+                                         row1 + x1 + c);
+            }
+        }
+    }
+}
+
+std::expected<void, std::string> cook_texture(const fs::path& source,
+                                              const fs::path& destination)
+{
+    int32_t width, height, channels;
+    auto pixels
+        = stbi_load(source.string().c_str(), &width, &height, &channels, 4);
+
+    if (!pixels) {
+        return std::unexpected(std::format("can't decode texture '{}': {}",
+                                           source.string(),
+                                           stbi_failure_reason()));
+    }
+
+    std::vector<texture_mip_t> mips;
+    std::vector<std::vector<uint8_t>> levels;
+
+    uint32_t mip_width = width;
+    uint32_t mip_height = height;
+
+    levels.emplace_back(pixels,
+                        pixels + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(pixels);
+
+    while (true) {
+        mips.push_back({ .size = levels.back().size(),
+                         .width = mip_width,
+                         .height = mip_height });
+
+        if (mip_width == 1 && mip_height == 1)
+            break;
+
+        auto next_width = std::max(mip_width / 2, 1u);
+        auto next_height = std::max(mip_height / 2, 1u);
+
+        std::vector<uint8_t> next(static_cast<size_t>(next_width)
+                                  * next_height * 4);
+        downsample(levels.back().data(),
+                   mip_width,
+                   mip_height,
+                   next.data(),
+                   next_width,
+                   next_height);
+
+        levels.push_back(std::move(next));
+        mip_width = next_width;
+        mip_height = next_height;
+    }
+
+    texture_header_t header {
+        .version = TEXTURE_VERSION,
+        .format = texture_format_t::rgba8,
+        .width = static_cast<uint32_t>(width),
+        .height = static_cast<uint32_t>(height),
+        .mip_count = static_cast<uint32_t>(mips.size()),
+    };
+    std::memcpy(header.magic, TEXTURE_MAGIC, sizeof(header.magic));
+
+    auto offset
+        = align_mip(sizeof(header) + mips.size() * sizeof(texture_mip_t));
+    for (auto& mip : mips) {
+        mip.offset = offset;
+        offset = align_mip(offset + mip.size);
+    }
+
+    std::ofstream stream(destination, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+        return std::unexpected(std::format(
+            "can't open '{}' for writing", destination.string()));
+    }
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(mips.data()),
+                 mips.size() * sizeof(texture_mip_t));
+
+    for (size_t i = 0; i < mips.size(); i++) {
+        stream.seekp(mips[i].offset);
+        stream.write(reinterpret_cast<const char*>(levels[i].data()),
+                     levels[i].size());
+    }
+
+    if (!stream) {
+        return std::unexpected(
+            std::format("failed to write '{}'", destination.string()));
+    }
+
+    return {};
+}
+
+std::expected<fs::path, std::string>
+cook_texture_cached(const fs::path& source)
+{
+    auto cooked = source;
+    cooked += ".ftex";
+
+    // packs ship the cooked textures, the sources may not exist at all.
+    if (resource_file_t::is_packed(cooked))
+        return cooked;
+
+    std::error_code error;
+    if (fs::exists(cooked, error)
+        && fs::last_write_time(cooked, error)
+            >= fs::last_write_time(source, error)
+        && !error) {
+        return cooked;
+    }
+
+    if (auto result = cook_texture(source, cooked); !result)
+        return std::unexpected(result.error());
+
+    return cooked;
+}
+
+std::expected<texture_t, std::string>
+texture_streamer_t::load(const fs::path& cooked_path)
+{
+    pending_texture_t pending;
+    if (auto result = pending.file.open(cooked_path); !result)
+        return std::unexpected(result.error());
+
+    auto data = pending.file.get_data();
+
+    texture_header_t header;
+    if (data.size() < sizeof(header)) {
+        return std::unexpected(
+            std::format("'{}' is not a cooked texture", cooked_path.string()));
+    }
+
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, TEXTURE_MAGIC, sizeof(header.magic))
+        || header.version != TEXTURE_VERSION
+        || header.format != texture_format_t::rgba8 || header.mip_count == 0) {
+        return std::unexpected(std::format(
+            "'{}' is not a supported cooked texture", cooked_path.string()));
+    }
+
+    // a full chain ends at 1x1, no texture has more levels than that.
+    auto max_mip_count = std::bit_width(std::max(header.width, header.height));
+    if (header.width == 0 || header.height == 0
+        || header.mip_count > max_mip_count) {
+        return std::unexpected(
+            std::format("'{}' is corrupted", cooked_path.string()));
+    }
+
+    auto table_size = header.mip_count * sizeof(texture_mip_t);
+    if (data.size() < sizeof(header) + table_size) {
+        return std::unexpected(
+            std::format("'{}' is truncated", cooked_path.string()));
+    }
+
+    pending.mips.resize(header.mip_count);
+    std::memcpy(pending.mips.data(), data.data() + sizeof(header), table_size);
+
+    int64_t total_size = 0;
+    for (uint32_t level = 0; level < header.mip_count; level++) {
+        const auto& mip = pending.mips[level];
+
+        if (mip.width != std::max(header.width >> level, 1u)
+            || mip.height != std::max(header.height >> level, 1u)
+            || mip.size != static_cast<uint64_t>(mip.width) * mip.height * 4) {
+            return std::unexpected(
+                std::format("'{}' is corrupted", cooked_path.string()));
+        }
+
+        if (mip.offset > data.size() || mip.size > data.size() - mip.offset) {
+            return std::unexpected(
+                std::format("'{}' is truncated", cooked_path.string()));
+        }
+
+        total_size += mip.size;
+    }
+
+    glGenTextures(1, &pending.texture);
+    glBindTexture(GL_TEXTURE_2D, pending.texture);
+    glTexStorage2D(
+        GL_TEXTURE_2D, header.mip_count, GL_RGBA8, header.width, header.height);
+
+    glTexParameteri(
+        GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, header.mip_count - 1);
+
+    memory_tracker_t::track_gpu(memory_tracker_t::GPU_TEXTURE_SCOPE,
+                                total_size);
+
+    pending.base_level = header.mip_count;
+    do {
+        upload_level(&pending, pending.base_level - 1);
+    } while (pending.base_level > 0
+             && pending.mips[pending.base_level - 1].width <= INITIAL_MIP_SIZE
+             && pending.mips[pending.base_level - 1].height
+                 <= INITIAL_MIP_SIZE);
+
+    texture_t texture {
+        .id = pending.texture,
+        .width = header.width,
+        .height = header.height,
+        .size = static_cast<uint64_t>(total_size),
+    };
+
+    if (pending.base_level > 0)
+        m_pending.push_back(std::move(pending));
+
+    return texture;
+}
+
+void texture_streamer_t::cancel(uint32_t texture)
+{
+    std::erase_if(m_pending, [texture](const pending_texture_t& pending) {
+        return pending.texture == texture;
+    });
+}
+
+void texture_streamer_t::update(size_t byte_budget)
+{
+    size_t uploaded = 0;
+
+    while (!m_pending.empty() && (uploaded == 0 || uploaded < byte_budget)) {
+        // sharpen the texture with the smallest pending mip first so every
+        // texture improves at the same pace.
+        auto next = std::ranges::min_element(
+            m_pending, {}, [](const pending_texture_t& pending) {
+                return pending.mips[pending.base_level - 1].size;
+            });
+
+        uploaded += next->mips[next->base_level - 1].size;
+        upload_level(&*next, next->base_level - 1);
+
+        if (next->base_level == 0)
+            m_pending.erase(next);
+    }
+}
+
+bool texture_streamer_t::is_idle() const
+{
+    return m_pending.empty();
+}
+
+bool texture_streamer_t::is_streaming(uint32_t texture) const
+{
+    return std::ranges::any_of(m_pending,
+                               [texture](const pending_texture_t& pending) {
+                                   return pending.texture == texture;
+                               });
+}
+
+void texture_streamer_t::upload_level(pending_texture_t* pending,
+                                      uint32_t level)
+{
+    const auto& mip = pending->mips[level];
+
+    glBindTexture(GL_TEXTURE_2D, pending->texture);
+    glTexSubImage2D(GL_TEXTURE_2D,
+                    level,
+                    0,
+                    0,
+                    mip.width,
+                    mip.height,
+                    GL_RGBA,
+                    GL_UNSIGNED_BYTE,
+                    pending->file.get_data().data() + mip.offset);
+
+    // never sample levels that haven't been uploaded yet.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+
+    pending->base_level = level;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <pack/pack.h>
+
+namespace fs = std::filesystem;
+
+// cooked textures (.ftex) hold a complete mip chain ready to be uploaded as
+// is. the file is a `texture_header_t`, followed by one `texture_mip_t` per
+// level (level 0 first) and the pixel data of every level.
+enum class texture_format_t : uint32_t {
+    rgba8 = 0,
+};
+
+struct texture_header_t {
+    char magic[8];
+    uint32_t version;
+    texture_format_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mip_count;
+    uint32_t reserved;
+};
+
+struct texture_mip_t {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t width;
+    uint32_t height;
+};
+
+struct texture_t {
+    uint32_t id;
+    uint32_t width;
+    uint32_t height;
+
+    // gpu memory used by the full mip chain.
+    uint64_t size;
+};
+
+// decodes `source` (png, jpg, tga, ...), builds its mip chain and writes it to
+// `destination`.
+std::expected<void, std::string> cook_texture(const fs::path& source,
+                                              const fs::path& destination);
+
+// returns the cooked version of `source`, cooking it first if it doesn't
+// exist yet or is older than the source. a cooked texture in the mounted
+// resource pack is used as is.
+std::expected<fs::path, std::string>
+cook_texture_cached(const fs::path& source);
+
+// uploads cooked textures mip by mip, smallest first. a texture is usable as
+// soon as `load` returns and gets sharper with every `update`.
+class texture_streamer_t {
+public:
+    // mips up to this size are uploaded by `load` itself.
+    static constexpr uint32_t INITIAL_MIP_SIZE = 64;
+
+    texture_streamer_t() { };
+
+    texture_streamer_t(const texture_streamer_t& other) = delete;
+    texture_streamer_t& operator=(const texture_streamer_t& other) = delete;
+
+    texture_streamer_t(texture_streamer_t&& other) = default;
+    texture_streamer_t& operator=(texture_streamer_t&& other) = default;
+
+    std::expected<texture_t, std::string> load(const fs::path& cooked_path);
+
+    // drops the pending mips of `texture`, must be called before deleting a
+    // texture that is still streaming.
+    void cancel(uint32_t texture);
+
+    // uploads pending mips until `byte_budget` is used up. at least one mip is
+    // uploaded per call if any is pending.
+    void update(size_t byte_budget);
+
+    bool is_idle() const;
+
+    bool is_streaming(uint32_t texture) const;
+
+private:
+    struct pending_texture_t {
+        uint32_t texture;
+        resource_file_t file;
+        std::vector<texture_mip_t> mips;
+
+        // finest level uploaded so far.
+        uint32_t base_level;
+    };
+
+    void upload_level(pending_texture_t* pending, uint32_t level);
+
+private:
+    std::vector<pending_texture_t> m_pending;
+};
@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <utility>
+
+#include <memory_stats.h>
+
+struct scope_counters_t {
+    std::atomic<uint64_t> allocations { 0 };
+    std::atomic<int64_t> live_bytes { 0 };
+    std::atomic<int64_t> peak_bytes { 0 };
+};
+
+static std::array<scope_counters_t, memory_tracker_t::MAX_SCOPES> s_counters;
+
+static std::mutex s_names_mutex;
+static std::vector<std::string> s_names;
+
+static thread_local uint32_t t_scope = memory_tracker_t::ENGINE_SCOPE;
+
+static void charge(uint32_t scope, int64_t bytes)
+{
+    auto& counters = s_counters[scope];
+
+    if (bytes > 0)
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+
+    auto live = counters.live_bytes.fetch_add(bytes, std::memory_order_relaxed)
+        + bytes;
+
+    auto peak = counters.peak_bytes.load(std::memory_order_relaxed);
+    while (live > peak
+           && !counters.peak_bytes.compare_exchange_weak(
+               peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+// expects `s_names_mutex` to be held.
+static void add_builtin_scopes()
+{
+    if (s_names.empty())
+        s_names = { "engine", "gpu buffers", "gpu textures" };
+}
+
+uint32_t memory_tracker_t::register_scope(std::string_view name)
+{
+    std::lock_guard lock(s_names_mutex);
+
+    add_builtin_scopes();
+
+    auto it = std::ranges::find(s_names, name);
+    if (it != s_names.end())
+        return static_cast<uint32_t>(it - s_names.begin());
+
+    if (s_names.size() >= MAX_SCOPES)
+        return ENGINE_SCOPE;
+
+    s_names.emplace_back(name);
+    return static_cast<uint32_t>(s_names.size() - 1);
+}
+
+uint32_t memory_tracker_t::set_scope(uint32_t scope)
+{
+    return std::exchange(t_scope, scope);
+}
+
+void memory_tracker_t::track_gpu(uint32_t scope, int64_t bytes)
+{
+    charge(scope, bytes);
+}
+
+bool memory_tracker_t::is_heap_tracking_enabled()
+{
+#ifdef FENGINE_MEMORY_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void memory_tracker_t::collect(memory_stats_t* stats)
+{
+    std::lock_guard lock(s_names_mutex);
+
+    add_builtin_scopes();
+
+    stats->heap_tracking = is_heap_tracking_enabled();
+    stats->scopes.resize(s_names.size());
+
+    for (size_t i = 0; i < s_names.size(); i++) {
+        auto& usage = stats->scopes[i];
+        const auto& counters = s_counters[i];
+
+        if (usage.name.empty())
+            usage.name = s_names[i];
+
+        auto total = counters.allocations.load(std::memory_order_relaxed);
+
+        usage.frame_allocations = total - usage.total_allocations;
+        usage.total_allocations = total;
+        usage.live_bytes = counters.live_bytes.load(std::memory_order_relaxed);
+        usage.peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+    }
+}
+
+#ifdef FENGINE_MEMORY_TRACKING
+
+// every tracked block is prefixed with its size and the scope it was charged
+// to, so frees are credited back to the right scope.
+struct allocation_header_t {
+    uint64_t size;
+    uint32_t scope;
+};
+
+static constexpr size_t HEADER_SIZE = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+static_assert(sizeof(allocation_header_t) <= HEADER_SIZE);
+
+static void* tracked_allocate(size_t size, size_t alignment)
+{
+    auto offset = std::max(alignment, HEADER_SIZE);
+
+    // aligned_alloc wants the size to be a multiple of the alignment.
+    auto total = (size + offset + offset - 1) & ~(offset - 1);
+
+#ifdef _WIN32
+    auto base = static_cast<std::byte*>(_aligned_malloc(total, offset));
+#else
+    auto base = static_cast<std::byte*>(std::aligned_alloc(offset, total));
+#endif
+    if (!base)
+        return nullptr;
+
+    auto ptr = base + offset;
+    auto header = reinterpret_cast<allocation_header_t*>(ptr - HEADER_SIZE);
+
+    header->size = size;
+    header->scope = t_scope;
+    charge(header->scope, static_cast<int64_t>(size));
+
+    return ptr;
+}
+
+static void tracked_free(void* ptr, size_t alignment)
+{
+    if (!ptr)
+        return;
+
+    auto offset = std::max(alignment, HEADER_SIZE);
+    auto bytes = static_cast<std::byte*>(ptr);
+    auto header = reinterpret_cast<allocation_header_t*>(bytes - HEADER_SIZE);
+
+    charge(header->scope, -static_cast<int64_t>(header->size));
+
+#ifdef _WIN32
+    _aligned_free(bytes - offset);
+#else
+    std::free(bytes - offset);
+#endif
+}
+
+void* operator new(size_t size)
+{
+    if (auto ptr = tracked_allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    if (auto ptr = tracked_allocate(size, static_cast<size_t>(alignment)))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    tracked_free(ptr, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* ptr, std::align_val_t alignment) noexcept
+{
+    tracked_free(ptr, static_cast<size_t>(alignment));
+}
+
+#endif
@@ -0,0 +1,497 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
+#include <physics_2d.h>
+
+// share of the penetration removed every step, the rest is left to keep
+// stacks from jittering.
+static constexpr float CORRECTION_PERCENT = 0.8f;
+
+static void resize_bodies(physics_world_2d_t::bodies_t* bodies, size_t count)
+{
+    bodies->x.resize(count);
+    bodies->y.resize(count);
+    bodies->velocity_x.resize(count);
+    bodies->velocity_y.resize(count);
+    bodies->half_width.resize(count);
+    bodies->half_height.resize(count);
+    bodies->inverse_mass.resize(count);
+    bodies->restitution.resize(count);
+    bodies->shape.resize(count);
+}
+
+// integrates one axis of every body. static bodies aren't accelerated.
+static void integrate_axis(float* position,
+                           float* velocity,
+                           const float* inverse_mass,
+                           size_t count,
+                           float acceleration,
+                           float dt)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    auto zero = _mm_setzero_ps();
+    auto dt4 = _mm_set1_ps(dt);
+    auto dv4 = _mm_set1_ps(acceleration * dt);
+
+    for (; i + 4 <= count; i += 4) {
+        auto p = _mm_loadu_ps(position + i);
+        auto v = _mm_loadu_ps(velocity + i);
+        auto dynamic = _mm_cmpneq_ps(_mm_loadu_ps(inverse_mass + i), zero);
+
+        v = _mm_add_ps(v, _mm_and_ps(dynamic, dv4));
+        p = _mm_add_ps(p, _mm_mul_ps(v, dt4));
+
+        _mm_storeu_ps(velocity + i, v);
+        _mm_storeu_ps(position + i, p);
+    }
+#endif
+
+    for (; i < count; i++) {
+        if (inverse_mass[i] != 0.0f)
+            velocity[i] += acceleration * dt;
+
+        position[i] += velocity[i] * dt;
+    }
+}
+
+// keeps every body of one axis inside [min, max] and reflects the velocity
+// of those that hit a side.
+static void bound_axis(float* position,
+                       float* velocity,
+                       const float* half,
+                       size_t count,
+                       float min,
+                       float max)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    auto min4 = _mm_set1_ps(min);
+    auto max4 = _mm_set1_ps(max);
+    auto sign = _mm_set1_ps(-0.0f);
+
+    auto select = [](__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    };
+
+    for (; i + 4 <= count; i += 4) {
+        auto p = _mm_loadu_ps(position + i);
+        auto v = _mm_loadu_ps(velocity + i);
+        auto h = _mm_loadu_ps(half + i);
+
+        auto low = _mm_add_ps(min4, h);
+        auto high = _mm_sub_ps(max4, h);
+
+        auto below = _mm_cmplt_ps(p, low);
+        auto above = _mm_cmpgt_ps(p, high);
+
+        auto speed = _mm_andnot_ps(sign, v);
+
+        v = select(below, speed, v);
+        v = select(above, _mm_or_ps(speed, sign), v);
+        p = _mm_min_ps(_mm_max_ps(p, low), high);
+
+        _mm_storeu_ps(velocity + i, v);
+        _mm_storeu_ps(position + i, p);
+    }
+#endif
+
+    for (; i < count; i++) {
+        auto low = min + half[i];
+        auto high = max - half[i];
+
+        if (position[i] < low) {
+            position[i] = low;
+            velocity[i] = std::abs(velocity[i]);
+        } else if (position[i] > high) {
+            position[i] = high;
+            velocity[i] = -std::abs(velocity[i]);
+        }
+    }
+}
+
+// std::floor is a library call without sse4.1.
+static int32_t floor_to_int(float value)
+{
+    auto truncated = static_cast<int32_t>(value);
+    return truncated - (value < static_cast<float>(truncated));
+}
+
+static uint32_t hash_cell(int32_t x, int32_t y, uint32_t mask)
+{
+    return ((static_cast<uint32_t>(x) * 73856093u)
+            ^ (static_cast<uint32_t>(y) * 19349663u))
+        & mask;
+}
+
+// fills the spatial hash. a body is added once to the bucket of every cell
+// its bounds overlap, buckets are built with a counting sort so no bucket
+// owns an allocation.
+static void build_grid(physics_world_2d_t* world,
+                       float inverse_cell_size,
+                       uint32_t mask)
+{
+    const auto& bodies = world->bodies;
+    auto count = bodies.x.size();
+
+    world->cell_start.assign(mask + 2, 0);
+
+    auto for_each_cell = [&](size_t body, auto func) {
+        auto min_x = floor_to_int(
+            (bodies.x[body] - bodies.half_width[body]) * inverse_cell_size);
+        auto min_y = floor_to_int(
+            (bodies.y[body] - bodies.half_height[body]) * inverse_cell_size);
+        auto max_x = floor_to_int(
+            (bodies.x[body] + bodies.half_width[body]) * inverse_cell_size);
+        auto max_y = floor_to_int(
+            (bodies.y[body] + bodies.half_height[body]) * inverse_cell_size);
+
+        // cells of a body can hash to the same bucket, a second copy would
+        // report every pair in it twice.
+        for (auto y = min_y; y <= max_y; y++) {
+            for (auto x = min_x; x <= max_x; x++) {
+                auto cell = hash_cell(x, y, mask);
+                if (world->cell_last_body[cell] == body)
+                    continue;
+
+                world->cell_last_body[cell] = static_cast<uint32_t>(body);
+                func(cell);
+            }
+        }
+    };
+
+    world->cell_last_body.assign(mask + 1, UINT32_MAX);
+
+    for (size_t i = 0; i < count; i++)
+        for_each_cell(i, [&](uint32_t cell) { world->cell_start[cell]++; });
+
+    // inclusive prefix sum, every entry ends up one past its bucket.
+    uint32_t total = 0;
+    for (auto& start : world->cell_start) {
+        total += start;
+        start = total;
+    }
+
+    world->cell_bodies.resize(total);
+    world->cell_last_body.assign(mask + 1, UINT32_MAX);
+
+    for (size_t i = 0; i < count; i++) {
+        for_each_cell(i, [&](uint32_t cell) {
+            world->cell_bodies[--world->cell_start[cell]] = i;
+        });
+    }
+}
+
+static bool collide(const physics_world_2d_t::bodies_t& bodies,
+                    uint32_t a,
+                    uint32_t b,
+                    glm::vec2* normal,
+                    float* depth)
+{
+    auto delta
+        = glm::vec2(bodies.x[b] - bodies.x[a], bodies.y[b] - bodies.y[a]);
+
+    auto shape_a = bodies.shape[a];
+    auto shape_b = bodies.shape[b];
+
+    if (shape_a == collider_shape_2d_t::aabb
+        && shape_b == collider_shape_2d_t::aabb) {
+        auto overlap_x = bodies.half_width[a] + bodies.half_width[b]
+            - std::abs(delta.x);
+        auto overlap_y = bodies.half_height[a] + bodies.half_height[b]
+            - std::abs(delta.y);
+
+        if (overlap_x <= 0.0f || overlap_y <= 0.0f)
+            return false;
+
+        if (overlap_x < overlap_y) {
+            *normal = glm::vec2(delta.x < 0.0f ? -1.0f : 1.0f, 0.0f);
+            *depth = overlap_x;
+        } else {
+            *normal = glm::vec2(0.0f, delta.y < 0.0f ? -1.0f : 1.0f);
+            *depth = overlap_y;
+        }
+
+        return true;
+    }
+
+    auto radius = [&bodies](uint32_t body) {
+        return std::min(bodies.half_width[body], bodies.half_height[body]);
+    };
+
+    if (shape_a == collider_shape_2d_t::circle
+        && shape_b == collider_shape_2d_t::circle) {
+        auto radii = radius(a) + radius(b);
+        auto distance_squared = glm::dot(delta, delta);
+
+        if (distance_squared >= radii * radii)
+            return false;
+
+        auto distance = std::sqrt(distance_squared);
+
+        *normal = distance > 0.0f ? delta / distance : glm::vec2(1.0f, 0.0f);
+        *depth = radii - distance;
+        return true;
+    }
+
+    // box against circle, solved from the box's point of view.
+    auto flip = shape_a == collider_shape_2d_t::circle;
+    auto box = flip ? b : a;
+    auto circle = flip ? a : b;
+    auto offset = flip ? -delta : delta;
+
+    auto half = glm::vec2(bodies.half_width[box], bodies.half_height[box]);
+    auto closest = glm::clamp(offset, -half, half);
+    auto r = radius(circle);
+
+    if (closest == offset) {
+        // the center of the circle is inside the box, push it out through the
+        // nearest side.
+        auto overlap = half - glm::abs(offset);
+
+        if (overlap.x < overlap.y) {
+            *normal = glm::vec2(offset.x < 0.0f ? -1.0f : 1.0f, 0.0f);
+            *depth = overlap.x + r;
+        } else {
+            *normal = glm::vec2(0.0f, offset.y < 0.0f ? -1.0f : 1.0f);
+            *depth = overlap.y + r;
+        }
+    } else {
+        auto distance_vector = offset - closest;
+        auto distance_squared = glm::dot(distance_vector, distance_vector);
+
+        if (distance_squared >= r * r)
+            return false;
+
+        auto distance = std::sqrt(distance_squared);
+
+        *normal = distance_vector / distance;
+        *depth = r - distance;
+    }
+
+    if (flip)
+        *normal = -*normal;
+
+    return true;
+}
+
+static void resolve(physics_world_2d_t::bodies_t* bodies,
+                    uint32_t a,
+                    uint32_t b,
+                    glm::vec2 normal,
+                    float depth)
+{
+    auto inverse_mass_a = bodies->inverse_mass[a];
+    auto inverse_mass_b = bodies->inverse_mass[b];
+    auto total = inverse_mass_a + inverse_mass_b;
+
+    auto correction = normal * (depth * CORRECTION_PERCENT / total);
+
+    bodies->x[a] -= correction.x * inverse_mass_a;
+    bodies->y[a] -= correction.y * inverse_mass_a;
+    bodies->x[b] += correction.x * inverse_mass_b;
+    bodies->y[b] += correction.y * inverse_mass_b;
+
+    auto relative_velocity
+        = glm::vec2(bodies->velocity_x[b] - bodies->velocity_x[a],
+                    bodies->velocity_y[b] - bodies->velocity_y[a]);
+    auto approach = glm::dot(relative_velocity, normal);
+
+    // already separating.
+    if (approach > 0.0f)
+        return;
+
+    auto restitution
+        = std::min(bodies->restitution[a], bodies->restitution[b]);
+    auto impulse = normal * (-(1.0f + restitution) * approach / total);
+
+    bodies->velocity_x[a] -= impulse.x * inverse_mass_a;
+    bodies->velocity_y[a] -= impulse.y * inverse_mass_a;
+    bodies->velocity_x[b] += impulse.x * inverse_mass_b;
+    bodies->velocity_y[b] += impulse.y * inverse_mass_b;
+}
+
+physics_2d_t::physics_2d_t(physics_2d_settings_t settings)
+    : m_settings(settings)
+{
+}
+
+PluginResult physics_2d_t::build(app_t* app)
+{
+    auto rg = app->get_registry();
+    rg.put_resource<physics_world_2d_t>(
+        physics_world_2d_t { .settings = m_settings });
+
+    app->add_system(make_startup(setup));
+    app->add_system(make_fixed_update<step>());
+
+    return {};
+}
+
+SystemResult physics_2d_t::setup(registry_t rg)
+{
+    rg.declare_group<quad_2d_t, rigid_body_2d_t>();
+    return {};
+}
+
+SystemResult physics_2d_t::step(resource_t<physics_world_2d_t> world,
+                                group_t<quad_2d_t, rigid_body_2d_t> group,
+                                float dt)
+{
+    auto& bodies = world->bodies;
+    const auto& settings = world->settings;
+
+    auto count = group.size();
+    resize_bodies(&bodies, count);
+    world->contacts.clear();
+    world->contact_bodies.clear();
+
+    if (!count)
+        return {};
+
+    size_t offset = 0;
+    float size_sum = 0.0f;
+
+    group.each_chunk([&](std::span<quad_2d_t> quads,
+                         std::span<rigid_body_2d_t> rigid_bodies) {
+        for (size_t i = 0; i < quads.size(); i++, offset++) {
+            auto half = quads[i].dimension * 0.5f;
+
+            bodies.x[offset] = quads[i].position.x + half.x;
+            bodies.y[offset] = quads[i].position.y + half.y;
+            bodies.velocity_x[offset] = rigid_bodies[i].velocity.x;
+            bodies.velocity_y[offset] = rigid_bodies[i].velocity.y;
+            bodies.half_width[offset] = half.x;
+            bodies.half_height[offset] = half.y;
+            bodies.inverse_mass[offset] = rigid_bodies[i].inverse_mass;
+            bodies.restitution[offset] = rigid_bodies[i].restitution;
+            bodies.shape[offset] = rigid_bodies[i].shape;
+
+            size_sum += quads[i].dimension.x + quads[i].dimension.y;
+        }
+    });
+
+    integrate_axis(bodies.x.data(),
+                   bodies.velocity_x.data(),
+                   bodies.inverse_mass.data(),
+                   count,
+                   settings.gravity.x,
+                   dt);
+    integrate_axis(bodies.y.data(),
+                   bodies.velocity_y.data(),
+                   bodies.inverse_mass.data(),
+                   count,
+                   settings.gravity.y,
+                   dt);
+
+    // broadphase, cells are about twice the size of an average body and
+    // there is one bucket per body.
+    auto cell_size = settings.cell_size > 0.0f
+        ? settings.cell_size
+        : std::max(size_sum / count, 1.0f);
+    auto inverse_cell_size = 1.0f / cell_size;
+    auto mask = static_cast<uint32_t>(std::bit_ceil(count)) - 1;
+
+    build_grid(&*world, inverse_cell_size, mask);
+
+    // narrowphase. a pair shares every cell both bodies overlap, it's only
+    // tested in the bucket of the cell holding the top left corner of the
+    // overlap.
+    for (uint32_t cell = 0; cell <= mask; cell++) {
+        auto begin = world->cell_start[cell];
+        auto end = world->cell_start[cell + 1];
+
+        for (auto i = begin; i < end; i++) {
+            for (auto j = i + 1; j < end; j++) {
+                auto a = world->cell_bodies[i];
+                auto b = world->cell_bodies[j];
+
+                if (bodies.inverse_mass[a] == 0.0f
+                    && bodies.inverse_mass[b] == 0.0f) {
+                    continue;
+                }
+
+                auto left = std::max(bodies.x[a] - bodies.half_width[a],
+                                     bodies.x[b] - bodies.half_width[b]);
+                auto top = std::max(bodies.y[a] - bodies.half_height[a],
+                                    bodies.y[b] - bodies.half_height[b]);
+                auto right = std::min(bodies.x[a] + bodies.half_width[a],
+                                      bodies.x[b] + bodies.half_width[b]);
+                auto bottom = std::min(bodies.y[a] + bodies.half_height[a],
+                                       bodies.y[b] + bodies.half_height[b]);
+
+                if (left > right || top > bottom)
+                    continue;
+
+                auto owner = hash_cell(floor_to_int(left * inverse_cell_size),
+                                       floor_to_int(top * inverse_cell_size),
+                                       mask);
+                if (owner != cell)
+                    continue;
+
+                glm::vec2 normal;
+                float depth;
+                if (!collide(bodies, a, b, &normal, &depth))
+                    continue;
+
+                world->contact_bodies.push_back(a);
+                world->contact_bodies.push_back(b);
+                world->contacts.push_back({ .normal = normal, .depth = depth });
+            }
+        }
+    }
+
+    const auto& contact_bodies = world->contact_bodies;
+
+    for (size_t i = 0; i < world->contacts.size(); i++) {
+        resolve(&bodies,
+                contact_bodies[i * 2],
+                contact_bodies[i * 2 + 1],
+                world->contacts[i].normal,
+                world->contacts[i].depth);
+    }
+
+    if (settings.use_bounds) {
+        bound_axis(bodies.x.data(),
+                   bodies.velocity_x.data(),
+                   bodies.half_width.data(),
+                   count,
+                   settings.bounds_min.x,
+                   settings.bounds_max.x);
+        bound_axis(bodies.y.data(),
+                   bodies.velocity_y.data(),
+                   bodies.half_height.data(),
+                   count,
+                   settings.bounds_min.y,
+                   settings.bounds_max.y);
+    }
+
+    // entities are laid out like the components of the group.
+    auto entities = group.storage<quad_2d_t>()->data();
+
+    for (size_t i = 0; i < world->contacts.size(); i++) {
+        world->contacts[i].a = entities[contact_bodies[i * 2]];
+        world->contacts[i].b = entities[contact_bodies[i * 2 + 1]];
+    }
+
+    offset = 0;
+    group.each_chunk([&](std::span<quad_2d_t> quads,
+                         std::span<rigid_body_2d_t> rigid_bodies) {
+        for (size_t i = 0; i < quads.size(); i++, offset++) {
+            quads[i].position.x = bodies.x[offset] - bodies.half_width[offset];
+            quads[i].position.y
+                = bodies.y[offset] - bodies.half_height[offset];
+            rigid_bodies[i].velocity.x = bodies.velocity_x[offset];
+            rigid_bodies[i].velocity.y = bodies.velocity_y[offset];
+        }
+    });
+
+    return {};
+}
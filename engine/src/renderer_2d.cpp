@@ -1,14 +1,74 @@
 #include <fecs.h>
+#include <memory_stats.h>
 #include <renderer_2d.h>
 #include <window_sdl.h>
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
 
-static constexpr uint32_t MAX_QUAD_COUNT = 12000;
-static constexpr uint32_t MAX_QUAD_VERTICES = MAX_QUAD_COUNT * 4;
-static constexpr uint32_t MAX_QUAD_INDICES = MAX_QUAD_COUNT * 6;
+// quads per draw call, the most that 16 bit indices can address. every draw
+// reuses the same indices, its base vertex moves them to its quads.
+static constexpr uint32_t BATCH_QUAD_COUNT = (UINT16_MAX + 1) / 4;
+static constexpr uint32_t BATCH_INDEX_COUNT = BATCH_QUAD_COUNT * 6;
+
+static constexpr int64_t QUAD_EBO_SIZE = BATCH_INDEX_COUNT * sizeof(uint16_t);
+
+static constexpr size_t MIN_QUAD_CAPACITY = 4096;
+
+// the vertex buffer is halved once a quarter of it was enough for this many
+// frames in a row.
+static constexpr uint32_t SHRINK_FRAMES = 120;
+
+static int64_t get_quad_vbo_size(size_t capacity)
+{
+    return static_cast<int64_t>(capacity * 4 * sizeof(quad_vertex_t));
+}
+
+static void resize_quad_vbo(render_data_2d_t* rd, size_t capacity)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, rd->quad_vbo);
+    glBufferData(GL_ARRAY_BUFFER,
+                 get_quad_vbo_size(capacity),
+                 nullptr,
+                 GL_STREAM_DRAW);
+
+    memory_tracker_t::track_gpu(memory_tracker_t::GPU_BUFFER_SCOPE,
+                                get_quad_vbo_size(capacity)
+                                    - get_quad_vbo_size(rd->quad_capacity));
+    rd->quad_capacity = capacity;
+}
+
+// grows the vertex buffer geometrically to fit `count` quads. it only shrinks
+// after staying mostly unused for a while, so a quad count that swings
+// between frames doesn't reallocate it every frame.
+static void reserve_quads(render_data_2d_t* rd, size_t count)
+{
+    if (count > rd->quad_capacity) {
+        auto capacity = std::max(rd->quad_capacity, MIN_QUAD_CAPACITY);
+        while (capacity < count)
+            capacity *= 2;
+
+        rd->idle_frames = 0;
+        resize_quad_vbo(rd, capacity);
+        return;
+    }
+
+    if (rd->quad_capacity <= MIN_QUAD_CAPACITY
+        || count > rd->quad_capacity / 4) {
+        rd->idle_frames = 0;
+        return;
+    }
+
+    if (++rd->idle_frames >= SHRINK_FRAMES) {
+        rd->idle_frames = 0;
+        resize_quad_vbo(rd, rd->quad_capacity / 2);
+        rd->quad_vertices.shrink_to_fit();
+    }
+}
 
 static SystemResult init(render_data_2d_t* rd, window_creation_info_t info)
 {
@@ -17,44 +77,34 @@ static SystemResult init(render_data_2d_t* rd, window_creation_info_t info)
         return std::unexpected(result.error());
     }
 
-    auto projection = glm::ortho(0.0f,
-                                 static_cast<float>(info.width),
-                                 static_cast<float>(info.height),
-                                 0.0f);
-    rd->shader.bind();
-
-    glUniformMatrix4fv(
-        glGetUniformLocation(rd->shader.get_id(), "u_projection"),
-        1,
-        GL_FALSE,
-        glm::value_ptr(projection));
+    rd->frame_uniforms.init();
+    rd->viewport_size = glm::vec2(info.width, info.height);
 
     glGenVertexArrays(1, &rd->quad_vao);
     glBindVertexArray(rd->quad_vao);
 
     glGenBuffers(1, &rd->quad_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, rd->quad_vbo);
-    glBufferData(GL_ARRAY_BUFFER,
-                 MAX_QUAD_VERTICES * sizeof(quad_vertex_t),
-                 nullptr,
-                 GL_DYNAMIC_DRAW);
-
-    uint32_t offset = 0;
-    uint32_t indices[MAX_QUAD_INDICES];
-    for (uint32_t i = 0; i < MAX_QUAD_INDICES; i += 6) {
-        indices[i + 0] = 0 + offset;
-        indices[i + 1] = 1 + offset;
-        indices[i + 2] = 2 + offset;
-        indices[i + 3] = 2 + offset;
-        indices[i + 4] = 3 + offset;
-        indices[i + 5] = 0 + offset;
+    resize_quad_vbo(rd, MIN_QUAD_CAPACITY);
+
+    std::vector<uint16_t> indices(BATCH_INDEX_COUNT);
+    for (uint32_t i = 0, offset = 0; i < BATCH_INDEX_COUNT; i += 6) {
+        indices[i + 0] = static_cast<uint16_t>(0 + offset);
+        indices[i + 1] = static_cast<uint16_t>(1 + offset);
+        indices[i + 2] = static_cast<uint16_t>(2 + offset);
+        indices[i + 3] = static_cast<uint16_t>(2 + offset);
+        indices[i + 4] = static_cast<uint16_t>(3 + offset);
+        indices[i + 5] = static_cast<uint16_t>(0 + offset);
         offset += 4;
     }
 
     glGenBuffers(1, &rd->quad_ebo);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, rd->quad_ebo);
-    glBufferData(
-        GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 QUAD_EBO_SIZE,
+                 indices.data(),
+                 GL_STATIC_DRAW);
+    memory_tracker_t::track_gpu(memory_tracker_t::GPU_BUFFER_SCOPE,
+                                QUAD_EBO_SIZE);
 
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(
@@ -76,39 +126,58 @@ static SystemResult init(render_data_2d_t* rd, window_creation_info_t info)
 
     glBindVertexArray(0);
 
-    rd->quad_vertices = new quad_vertex_t[MAX_QUAD_VERTICES];
-    rd->quad_vertices_ptr = rd->quad_vertices;
+    rd->gpu_timer.init();
 
     return {};
 }
 
-static void drawing_start(render_data_2d_t* rd)
+// uploads the quads of the frame at once and draws them in batches.
+static void submit_quads(render_data_2d_t* rd)
 {
-    rd->quad_index_count = 0;
-    rd->quad_vertices_ptr = rd->quad_vertices;
-}
+    auto count = rd->quad_vertices.size() / 4;
+    reserve_quads(rd, count);
 
-static void drawing_end(render_data_2d_t* rd)
-{
-    if (rd->quad_index_count) {
-        auto size = (rd->quad_vertices_ptr - rd->quad_vertices)
-            * sizeof(quad_vertex_t);
+    if (!count)
+        return;
+
+    auto size = rd->quad_vertices.size() * sizeof(quad_vertex_t);
+
+    // invalidating lets the driver hand out fresh storage instead of waiting
+    // for the draws of the previous frame.
+    glBindBuffer(GL_ARRAY_BUFFER, rd->quad_vbo);
+    auto vertices = glMapBufferRange(GL_ARRAY_BUFFER,
+                                     0,
+                                     size,
+                                     GL_MAP_WRITE_BIT
+                                         | GL_MAP_INVALIDATE_BUFFER_BIT);
 
-        glBindBuffer(GL_ARRAY_BUFFER, rd->quad_vbo);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, size, rd->quad_vertices);
+    // nothing is drawn this frame if the driver can't map the buffer.
+    if (!vertices)
+        return;
 
-        rd->shader.bind();
-        glBindVertexArray(rd->quad_vao);
+    std::memcpy(vertices, rd->quad_vertices.data(), size);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
 
-        glDrawElements(
-            GL_TRIANGLES, rd->quad_index_count, GL_UNSIGNED_INT, nullptr);
+    rd->shader.bind();
+    glBindVertexArray(rd->quad_vao);
 
-        glBindVertexArray(0);
+    for (size_t first = 0; first < count; first += BATCH_QUAD_COUNT) {
+        auto batch = std::min<size_t>(count - first, BATCH_QUAD_COUNT);
+
+        glDrawElementsBaseVertex(GL_TRIANGLES,
+                                 static_cast<int32_t>(batch * 6),
+                                 GL_UNSIGNED_SHORT,
+                                 nullptr,
+                                 static_cast<int32_t>(first * 4));
     }
+
+    glBindVertexArray(0);
 }
 
-renderer_2d_t::renderer_2d_t(window_sdl_t window)
+renderer_2d_t::renderer_2d_t(window_sdl_t window,
+                             frame_capture_settings_t capture)
     : m_window(std::move(window))
+    , m_capture(std::move(capture))
 {
 }
 
@@ -119,12 +188,15 @@ PluginResult renderer_2d_t::build(app_t* app)
 
     auto rg = app->get_registry();
     rg.put_resource<window_creation_info_t>(m_window.get_creation_info());
+    rg.put_resource<frame_capture_settings_t>(m_capture);
 
     app->add_system(make_startup(setup));
 
-    app->add_system(make_update(begin_drawing));
-    app->add_system(make_update(fetch_quads));
-    app->add_system(make_update(end_drawing));
+    m_window.add_late_input_sampling(app);
+
+    app->add_system(make_update<begin_drawing>());
+    app->add_system(make_update<fetch_quads>());
+    app->add_system(make_update<end_drawing>());
 
     app->add_system(make_shutdown(shutdown));
 
@@ -141,64 +213,98 @@ SystemResult renderer_2d_t::setup(registry_t rg)
 
     glViewport(0, 0, info.width, info.height);
 
+    if (auto& capture = rg.get_resource<frame_capture_settings_t>();
+        capture.on_frame) {
+        rd.readback = std::make_unique<readback_ring_t>();
+        if (auto result = rd.readback->init(info.width, info.height, capture);
+            !result) {
+            return result;
+        }
+    }
+
     rg.put_resource<render_data_2d_t>(std::move(rd));
     return {};
 }
 
-SystemResult renderer_2d_t::begin_drawing(registry_t rg, float)
+SystemResult
+renderer_2d_t::begin_drawing(resource_t<render_data_2d_t> rd,
+                             resource_t<const input_events_t> events,
+                             float dt)
 {
-    auto& sdl_context = rg.get_resource<sdl_context_t>();
-    auto& rd = rg.get_resource<render_data_2d_t>();
+    // captured frames keep the size the capture started with. a minimized
+    // window has no size, the viewport keeps the last one.
+    for (const auto& event : events->get_events()) {
+        if (event.type == input_event_type_t::window_resized
+            && event.size.x > 0 && event.size.y > 0 && !rd->readback) {
+            rd->viewport_size = event.size;
+            glViewport(0, 0, event.size.x, event.size.y);
+        }
+    }
 
+    rd->time += dt;
+
+    auto projection
+        = glm::ortho(0.0f, rd->viewport_size.x, rd->viewport_size.y, 0.0f);
+
+    rd->frame_uniforms.update({
+        .projection = projection,
+        .view_projection = projection,
+        .viewport = glm::vec4(rd->viewport_size, 1.0f / rd->viewport_size),
+        .time = rd->time,
+        .delta_time = dt,
+    });
+
+    rd->gpu_timer.begin_frame();
+
+    if (rd->readback)
+        rd->readback->bind();
+
+    rd->gpu_timer.begin_pass("clear");
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
+    rd->gpu_timer.end_pass();
 
-    drawing_start(&rd);
+    rd->gpu_timer.begin_pass("quads");
 
     return {};
 }
 
-SystemResult renderer_2d_t::fetch_quads(registry_t rg, float)
+SystemResult
+renderer_2d_t::fetch_quads(resource_t<render_data_2d_t> render_data,
+                           query_t<const quad_2d_t> quads)
 {
-    auto& rd = rg.get_resource<render_data_2d_t>();
-
-    auto view = rg.get_view<quad_2d_t>();
-    for (const auto& entity : view) {
-        const auto& [position, dimension] = view.get<quad_2d_t>(entity);
-
-        if (rd.quad_index_count >= MAX_QUAD_INDICES) {
-            drawing_end(&rd);
-            drawing_start(&rd);
-        }
+    auto& rd = *render_data;
 
-        rd.quad_vertices_ptr->position = glm::vec2(position.x, position.y);
-        rd.quad_vertices_ptr++;
+    // only builds the vertices, they are submitted by `end_drawing`.
+    rd.quad_vertices.resize(quads.size() * 4);
+    auto vertex = rd.quad_vertices.data();
 
-        rd.quad_vertices_ptr->position
-            = glm::vec2(position.x, position.y + dimension.y);
-        rd.quad_vertices_ptr++;
+    quads.each([&vertex](const quad_2d_t& quad) {
+        const auto& [position, dimension] = quad;
 
-        rd.quad_vertices_ptr->position
-            = glm::vec2(position.x + dimension.x, position.y + dimension.y);
-        rd.quad_vertices_ptr++;
-
-        rd.quad_vertices_ptr->position
-            = glm::vec2(position.x + dimension.x, position.y);
-        rd.quad_vertices_ptr++;
-
-        rd.quad_index_count += 6;
-    }
+        vertex[0].position = position;
+        vertex[1].position = glm::vec2(position.x, position.y + dimension.y);
+        vertex[2].position = position + dimension;
+        vertex[3].position = glm::vec2(position.x + dimension.x, position.y);
+        vertex += 4;
+    });
 
     return {};
 }
 
-SystemResult renderer_2d_t::end_drawing(registry_t rg, float)
+SystemResult
+renderer_2d_t::end_drawing(resource_t<const sdl_context_t> sdl_context,
+                           resource_t<render_data_2d_t> rd,
+                           resource_t<frame_timings_t*> timings)
 {
-    auto& sdl_context = rg.get_resource<sdl_context_t>();
-    auto& rd = rg.get_resource<render_data_2d_t>();
+    submit_quads(&*rd);
+    rd->gpu_timer.end_pass();
+    rd->gpu_timer.collect(*timings);
+
+    if (rd->readback)
+        rd->readback->end_frame();
 
-    drawing_end(&rd);
-    SDL_GL_SwapWindow(sdl_context.window);
+    SDL_GL_SwapWindow(sdl_context->window);
 
     return {};
 }
@@ -207,12 +313,19 @@ SystemResult renderer_2d_t::shutdown(registry_t rg)
 {
     auto& render_data = rg.get_resource<render_data_2d_t>();
 
-    delete render_data.quad_vertices;
-
     glDeleteBuffers(1, &render_data.quad_ebo);
     glDeleteBuffers(1, &render_data.quad_vbo);
+    memory_tracker_t::track_gpu(
+        memory_tracker_t::GPU_BUFFER_SCOPE,
+        -(get_quad_vbo_size(render_data.quad_capacity) + QUAD_EBO_SIZE));
     glDeleteVertexArrays(1, &render_data.quad_vao);
 
+    render_data.gpu_timer.destroy();
+    render_data.frame_uniforms.destroy();
+
+    if (render_data.readback)
+        render_data.readback->destroy();
+
     glDeleteProgram(render_data.shader.get_id());
 
     return {};
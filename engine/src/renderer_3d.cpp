@@ -0,0 +1,533 @@
+#include <fecs.h>
+#include <memory_stats.h>
+#include <renderer_3d.h>
+#include <window_sdl.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+
+// per instance attributes take the locations after the vertex attributes of
+// `vertex_t`, a mat4 takes four.
+static constexpr uint32_t INSTANCE_LOCATION = 3;
+
+static constexpr size_t MIN_INSTANCE_CAPACITY = 1024;
+
+// the bvh is rebuilt once refitting has grown the area of its nodes by this
+// much.
+static constexpr float MAX_REFIT_COST = 1.5f;
+
+static uint64_t batch_key(model_handle_t model)
+{
+    return static_cast<uint64_t>(model.index) << 32 | model.generation;
+}
+
+static bool is_batched(const instance_batches_t& batches, entt::entity entity)
+{
+    auto index = entt::to_entity(entity);
+    return index < batches.slots.size()
+        && batches.slots[index].batch != instance_batches_t::NO_BATCH;
+}
+
+// only entities with a `world_transform_t` are batched, an instance is added
+// when the later of the two components is constructed.
+static void add_instance(entt::registry& rg, entt::entity entity)
+{
+    if (!rg.all_of<model_instance_t, world_transform_t>(entity))
+        return;
+
+    auto& batches = rg.ctx().get<instance_batches_t>();
+    if (is_batched(batches, entity))
+        return;
+
+    auto model = rg.get<model_instance_t>(entity).model;
+
+    auto [it, inserted] = batches.lookup.try_emplace(
+        batch_key(model), static_cast<uint32_t>(batches.batches.size()));
+    if (inserted)
+        batches.batches.push_back({ .model = model });
+
+    if (auto assets = rg.ctx().find<asset_manager_t>())
+        assets->acquire(model);
+
+    auto& batch = batches.batches[it->second];
+
+    auto index = entt::to_entity(entity);
+    if (index >= batches.slots.size())
+        batches.slots.resize(index + 1);
+
+    batches.slots[index] = {
+        .batch = it->second,
+        .index = static_cast<uint32_t>(batch.entities.size()),
+    };
+    batch.entities.push_back(entity);
+
+    batches.version++;
+}
+
+static void remove_instance(entt::registry& rg, entt::entity entity)
+{
+    auto& batches = rg.ctx().get<instance_batches_t>();
+    if (!is_batched(batches, entity))
+        return;
+
+    auto& slot = batches.slots[entt::to_entity(entity)];
+
+    auto batch_index = slot.batch;
+    auto& batch = batches.batches[batch_index];
+
+    // swap the last instance into the removed one.
+    auto last = batch.entities.back();
+    batch.entities[slot.index] = last;
+    batches.slots[entt::to_entity(last)].index = slot.index;
+    batch.entities.pop_back();
+
+    slot = {};
+    batches.version++;
+
+    if (auto assets = rg.ctx().find<asset_manager_t>())
+        assets->release(batch.model);
+
+    if (!batch.entities.empty())
+        return;
+
+    batches.lookup.erase(batch_key(batch.model));
+
+    // the last batch takes the place of the empty one.
+    auto& moved = batches.batches.back();
+    if (&moved != &batch) {
+        for (auto moved_entity : moved.entities)
+            batches.slots[entt::to_entity(moved_entity)].batch = batch_index;
+
+        batches.lookup[batch_key(moved.model)] = batch_index;
+        batch = std::move(moved);
+    }
+
+    batches.batches.pop_back();
+}
+
+static void replace_instance(entt::registry& rg, entt::entity entity)
+{
+    remove_instance(rg, entity);
+    add_instance(rg, entity);
+}
+
+static SystemResult init(render_data_3d_t* rd, window_creation_info_t info)
+{
+    if (auto result = rd->shader.load_shader("resources/shaders/instanced.qsh");
+        !result) {
+        return std::unexpected(result.error());
+    }
+
+    rd->viewport_size = glm::vec2(info.width, info.height);
+    rd->frame_uniforms.init();
+
+    glGenBuffers(1, &rd->instance_vbo);
+    glGenBuffers(1, &rd->light_ssbo);
+    glGenBuffers(1, &rd->cluster_offset_ssbo);
+    glGenBuffers(1, &rd->light_index_ssbo);
+
+    rd->gpu_timer.init();
+
+    return {};
+}
+
+// grows the instance buffer to fit `count` transforms.
+static void reserve_instances(render_data_3d_t* rd, size_t count)
+{
+    if (count <= rd->instance_capacity)
+        return;
+
+    auto capacity = std::max(rd->instance_capacity, MIN_INSTANCE_CAPACITY);
+    while (capacity < count)
+        capacity *= 2;
+
+    glBufferData(GL_ARRAY_BUFFER,
+                 capacity * sizeof(glm::mat4),
+                 nullptr,
+                 GL_STREAM_DRAW);
+
+    memory_tracker_t::track_gpu(
+        memory_tracker_t::GPU_BUFFER_SCOPE,
+        static_cast<int64_t>((capacity - rd->instance_capacity)
+                             * sizeof(glm::mat4)));
+    rd->instance_capacity = capacity;
+}
+
+// copies `size` bytes into a storage buffer bound at `binding`, growing it
+// when it's too small.
+static void upload_storage(uint32_t buffer,
+                           uint32_t binding,
+                           const void* data,
+                           size_t size,
+                           size_t* capacity)
+{
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+
+    if (size > *capacity) {
+        auto grown = std::max(size, *capacity * 2);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, grown, nullptr, GL_STREAM_DRAW);
+
+        memory_tracker_t::track_gpu(memory_tracker_t::GPU_BUFFER_SCOPE,
+                                    static_cast<int64_t>(grown - *capacity));
+        *capacity = grown;
+    }
+
+    if (size)
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, data);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+}
+
+// points the instance attributes of the bound vertex array at the transforms
+// starting at `first`.
+static void bind_instances(size_t first)
+{
+    for (uint32_t i = 0; i < 4; i++) {
+        auto offset = first * sizeof(glm::mat4) + i * sizeof(glm::vec4);
+
+        glEnableVertexAttribArray(INSTANCE_LOCATION + i);
+        glVertexAttribPointer(INSTANCE_LOCATION + i,
+                              4,
+                              GL_FLOAT,
+                              GL_FALSE,
+                              sizeof(glm::mat4),
+                              reinterpret_cast<const void*>(offset));
+        glVertexAttribDivisor(INSTANCE_LOCATION + i, 1);
+    }
+}
+
+renderer_3d_t::renderer_3d_t(window_sdl_t window)
+    : m_window(std::move(window))
+{
+}
+
+PluginResult renderer_3d_t::build(app_t* app)
+{
+    if (auto result = m_window.build(app); !result)
+        return result;
+
+    auto rg = app->get_registry();
+    rg.put_resource<window_creation_info_t>(m_window.get_creation_info());
+    rg.put_resource<instance_batches_t>();
+    rg.put_resource<camera_t>();
+
+    auto native = rg.get_native();
+    native->on_construct<model_instance_t>().connect<&add_instance>();
+    native->on_update<model_instance_t>().connect<&replace_instance>();
+    native->on_destroy<model_instance_t>().connect<&remove_instance>();
+    native->on_construct<world_transform_t>().connect<&add_instance>();
+    native->on_destroy<world_transform_t>().connect<&remove_instance>();
+
+    app->add_system(make_startup(setup));
+
+    app->add_system(make_update<begin_drawing>());
+
+    // right before the view is built from the camera.
+    m_window.add_late_input_sampling(app);
+
+    app->add_system(make_update<cull_instances>());
+    app->add_system(make_update<cull_lights>());
+    app->add_system(make_update<draw_instances>());
+    app->add_system(make_update<end_drawing>());
+
+    app->add_system(make_shutdown(shutdown));
+
+    return {};
+}
+
+SystemResult renderer_3d_t::setup(registry_t rg)
+{
+    auto info = rg.get_resource<window_creation_info_t>();
+
+    render_data_3d_t rd;
+    if (auto result = init(&rd, info); !result)
+        return result;
+
+    glViewport(0, 0, info.width, info.height);
+    glEnable(GL_DEPTH_TEST);
+
+    rg.put_resource<render_data_3d_t>(std::move(rd));
+    return {};
+}
+
+SystemResult
+renderer_3d_t::begin_drawing(resource_t<render_data_3d_t> rd,
+                             resource_t<const input_events_t> events,
+                             float dt)
+{
+    // a minimized window has no size, the viewport keeps the last one.
+    for (const auto& event : events->get_events()) {
+        if (event.type == input_event_type_t::window_resized
+            && event.size.x > 0 && event.size.y > 0) {
+            rd->viewport_size = event.size;
+            glViewport(0, 0, event.size.x, event.size.y);
+        }
+    }
+
+    rd->time += dt;
+    rd->frame.time = rd->time;
+    rd->frame.delta_time = dt;
+
+    rd->gpu_timer.begin_frame();
+
+    rd->gpu_timer.begin_pass("clear");
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    rd->gpu_timer.end_pass();
+
+    return {};
+}
+
+SystemResult
+renderer_3d_t::cull_instances(resource_t<render_data_3d_t> render_data,
+                              resource_t<const instance_batches_t> batches,
+                              resource_t<asset_manager_t> assets,
+                              resource_t<camera_t> camera,
+                              resource_t<input_state_t> input,
+                              query_t<const world_transform_t> transforms)
+{
+    auto& rd = *render_data;
+
+    // the late motion is used up here instead of in the next frame.
+    if (camera->has_mouse_look()) {
+        camera->process_mouse_delta(input->late_mouse_delta);
+        input->late_mouse_delta = glm::vec2(0.0f);
+    }
+
+    auto projection = camera->get_projection_matrix(
+        rd.fov, rd.viewport_size.x, rd.viewport_size.y);
+
+    rd.view = camera->get_view_matrix();
+    rd.view_projection = projection * rd.view;
+
+    rd.frame.projection = projection;
+    rd.frame.view = rd.view;
+    rd.frame.view_projection = rd.view_projection;
+    rd.frame.viewport = glm::vec4(rd.viewport_size, 1.0f / rd.viewport_size);
+    rd.frame_uniforms.update(rd.frame);
+
+    rd.instance_bounds.clear();
+    rd.visible_counts.assign(batches->batches.size(), 0);
+
+    for (const auto& batch : batches->batches) {
+        auto model = assets->get(batch.model);
+        auto local = model ? model->bounds : aabb_t {};
+
+        // batched entities always have a world transform, so the bvh, the
+        // visible flags and the draw list cover the same instances.
+        for (auto entity : batch.entities) {
+            const auto& world = transforms.get<world_transform_t>(entity);
+            rd.instance_bounds.push_back(transform_aabb(local, world.matrix));
+        }
+    }
+
+    // moving instances only refit the tree until it has grown too loose.
+    if (rd.bvh_version != batches->version
+        || rd.bvh.get_size() != rd.instance_bounds.size()) {
+        rd.bvh.build(rd.instance_bounds);
+        rd.bvh_version = batches->version;
+    } else {
+        rd.bvh.refit(rd.instance_bounds);
+
+        if (rd.bvh.get_cost() > MAX_REFIT_COST)
+            rd.bvh.build(rd.instance_bounds);
+    }
+
+    rd.visible.resize(rd.instance_bounds.size());
+    rd.bvh.cull(
+        make_frustum(rd.view_projection), rd.instance_bounds, rd.visible);
+
+    size_t instance = 0;
+    for (size_t i = 0; i < batches->batches.size(); i++) {
+        for (size_t j = 0; j < batches->batches[i].entities.size(); j++)
+            rd.visible_counts[i] += rd.visible[instance++];
+    }
+
+    return {};
+}
+
+SystemResult renderer_3d_t::cull_lights(
+    resource_t<render_data_3d_t> render_data,
+    resource_t<const camera_t> camera,
+    query_t<const point_light_t, const world_transform_t> lights)
+{
+    auto& rd = *render_data;
+
+    auto projection = camera->get_projection_matrix(
+        rd.fov, rd.viewport_size.x, rd.viewport_size.y);
+    if (projection != rd.light_projection) {
+        rd.light_clusters.set_projection(
+            projection, camera_t::NEAR_PLANE, camera_t::FAR_PLANE);
+        rd.light_projection = projection;
+    }
+
+    rd.light_spheres.clear();
+    rd.gpu_lights.clear();
+
+    for (auto [entity, light, transform] : lights.each()) {
+        rd.light_spheres.push_back(
+            glm::vec4(glm::vec3(transform.matrix[3]), light.radius));
+        rd.gpu_lights.push_back({
+            .color = glm::vec4(light.color * light.intensity, 1.0f),
+        });
+    }
+
+    rd.light_clusters.cull(rd.view, rd.light_spheres);
+
+    auto view_lights = rd.light_clusters.get_view_lights();
+    for (size_t i = 0; i < view_lights.size(); i++)
+        rd.gpu_lights[i].position_radius = view_lights[i];
+
+    auto offsets = rd.light_clusters.get_offsets();
+    auto indices = rd.light_clusters.get_light_indices();
+
+    upload_storage(rd.light_ssbo,
+                   0,
+                   rd.gpu_lights.data(),
+                   rd.gpu_lights.size() * sizeof(gpu_point_light_t),
+                   &rd.light_capacity);
+    upload_storage(rd.cluster_offset_ssbo,
+                   1,
+                   offsets.data(),
+                   offsets.size_bytes(),
+                   &rd.cluster_offset_capacity);
+    upload_storage(rd.light_index_ssbo,
+                   2,
+                   indices.data(),
+                   indices.size_bytes(),
+                   &rd.light_index_capacity);
+
+    return {};
+}
+
+SystemResult
+renderer_3d_t::draw_instances(resource_t<render_data_3d_t> render_data,
+                              resource_t<const instance_batches_t> batches,
+                              resource_t<asset_manager_t> assets,
+                              query_t<const world_transform_t> transforms)
+{
+    auto& rd = *render_data;
+
+    size_t count = 0;
+    for (auto visible_count : rd.visible_counts)
+        count += visible_count;
+
+    if (!count)
+        return {};
+
+    rd.gpu_timer.begin_pass("instances");
+
+    glBindBuffer(GL_ARRAY_BUFFER, rd.instance_vbo);
+    reserve_instances(&rd, count);
+
+    // invalidating lets the driver hand out fresh storage instead of waiting
+    // for the draws of the previous frame.
+    auto instances = static_cast<glm::mat4*>(
+        glMapBufferRange(GL_ARRAY_BUFFER,
+                         0,
+                         count * sizeof(glm::mat4),
+                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+
+    // nothing is drawn this frame if the driver can't map the buffer.
+    if (!instances) {
+        rd.gpu_timer.end_pass();
+        return {};
+    }
+
+    size_t instance = 0;
+    for (const auto& batch : batches->batches) {
+        for (auto entity : batch.entities) {
+            if (rd.visible[instance++])
+                *instances++ = transforms.get<world_transform_t>(entity).matrix;
+        }
+    }
+
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+
+    rd.shader.bind();
+
+    auto program = rd.shader.get_id();
+    glUniform1i(glGetUniformLocation(program, "u_diffuse_texture"), 0);
+
+    glUniform1f(glGetUniformLocation(program, "u_slice_scale"),
+                rd.light_clusters.get_slice_scale());
+    glUniform1f(glGetUniformLocation(program, "u_slice_bias"),
+                rd.light_clusters.get_slice_bias());
+
+    auto diffuse_color = glGetUniformLocation(program, "u_diffuse_color");
+    auto has_texture = glGetUniformLocation(program, "u_has_texture");
+
+    glActiveTexture(GL_TEXTURE0);
+
+    size_t first = 0;
+    for (size_t i = 0; i < batches->batches.size(); i++) {
+        auto instance_count = rd.visible_counts[i];
+        auto model = assets->get(batches->batches[i].model);
+
+        if (model && instance_count) {
+            for (const auto& mesh : model->meshes) {
+                const auto& material = model->materials[mesh.mat_index];
+
+                glUniform3fv(
+                    diffuse_color, 1, glm::value_ptr(material.diff_color));
+                glUniform1i(has_texture, material.diff_texture != 0);
+                glBindTexture(GL_TEXTURE_2D, material.diff_texture);
+
+                glBindVertexArray(mesh.vao);
+                bind_instances(first);
+
+                glDrawElementsInstanced(GL_TRIANGLES,
+                                        mesh.indices.size(),
+                                        GL_UNSIGNED_INT,
+                                        nullptr,
+                                        instance_count);
+            }
+        }
+
+        first += instance_count;
+    }
+
+    glBindVertexArray(0);
+
+    rd.gpu_timer.end_pass();
+
+    return {};
+}
+
+SystemResult
+renderer_3d_t::end_drawing(resource_t<const sdl_context_t> sdl_context,
+                           resource_t<render_data_3d_t> rd,
+                           resource_t<frame_timings_t*> timings)
+{
+    rd->gpu_timer.collect(*timings);
+
+    SDL_GL_SwapWindow(sdl_context->window);
+
+    return {};
+}
+
+SystemResult renderer_3d_t::shutdown(registry_t rg)
+{
+    auto& render_data = rg.get_resource<render_data_3d_t>();
+
+    glDeleteBuffers(1, &render_data.instance_vbo);
+    glDeleteBuffers(1, &render_data.light_ssbo);
+    glDeleteBuffers(1, &render_data.cluster_offset_ssbo);
+    glDeleteBuffers(1, &render_data.light_index_ssbo);
+    memory_tracker_t::track_gpu(
+        memory_tracker_t::GPU_BUFFER_SCOPE,
+        -static_cast<int64_t>(render_data.instance_capacity
+                                  * sizeof(glm::mat4)
+                              + render_data.light_capacity
+                              + render_data.cluster_offset_capacity
+                              + render_data.light_index_capacity));
+
+    render_data.gpu_timer.destroy();
+    render_data.frame_uniforms.destroy();
+
+    glDeleteProgram(render_data.shader.get_id());
+
+    return {};
+}
@@ -0,0 +1,292 @@
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <print>
+#include <random>
+
+#include <replay.h>
+
+#include <mapped_file/mapped_file.h>
+
+static constexpr char REPLAY_MAGIC[8] = {
+    'F', 'E', 'R', 'E', 'P', 'L', 'A', 'Y'
+};
+
+struct replay_header_t {
+    char magic[8];
+    uint32_t version;
+    uint32_t seed_count;
+    uint32_t frame_count;
+    uint32_t event_count;
+};
+
+static uint64_t make_random_seed()
+{
+    std::random_device device;
+    return static_cast<uint64_t>(device()) << 32 | device();
+}
+
+replay_t::replay_t(replay_mode_t mode, fs::path path)
+    : m_mode(mode)
+    , m_path(std::move(path))
+{
+}
+
+replay_mode_t replay_t::get_mode() const
+{
+    return m_mode;
+}
+
+uint64_t replay_t::make_seed()
+{
+    if (m_mode == replay_mode_t::record) {
+        m_seeds.push_back(make_random_seed());
+        return m_seeds.back();
+    }
+
+    if (m_next_seed < m_seeds.size())
+        return m_seeds[m_next_seed++];
+
+    std::println(stderr,
+                 "WARNING: '{}' has no more recorded seeds, the replay "
+                 "diverges from the recording",
+                 m_path.string());
+    return make_random_seed();
+}
+
+void replay_t::record_frame(float delta_time,
+                            std::span<const input_event_t> events,
+                            const input_state_t& state)
+{
+    m_frames.push_back({
+        .delta_time = delta_time,
+        .event_count = static_cast<uint32_t>(events.size()),
+        .mouse_buttons = state.mouse_buttons,
+        .mouse_position = state.mouse_position,
+        .mouse_delta = state.mouse_delta,
+    });
+
+    m_events.insert(m_events.end(), events.begin(), events.end());
+}
+
+std::optional<float> replay_t::next_frame()
+{
+    if (m_frame == SIZE_MAX) {
+        m_frame = 0;
+    } else if (m_frame < m_frames.size()) {
+        m_event += m_frames[m_frame].event_count;
+        m_frame++;
+    }
+
+    if (m_frame >= m_frames.size())
+        return {};
+
+    return m_frames[m_frame].delta_time;
+}
+
+void replay_t::apply_input(input_events_t* events, input_state_t* state) const
+{
+    state->keys_pressed.fill(0);
+    state->keys_released.fill(0);
+    state->wheel_delta = glm::vec2(0.0f);
+
+    if (m_frame >= m_frames.size()) {
+        events->swap();
+        return;
+    }
+
+    const auto& frame = m_frames[m_frame];
+
+    for (uint32_t i = 0; i < frame.event_count; i++) {
+        const auto& event = m_events[m_event + i];
+
+        if (event.type == input_event_type_t::key_down) {
+            state->keys_down[event.scancode] = 1;
+            state->keys_pressed[event.scancode] = 1;
+        } else if (event.type == input_event_type_t::key_up) {
+            state->keys_down[event.scancode] = 0;
+            state->keys_released[event.scancode] = 1;
+        } else if (event.type == input_event_type_t::mouse_wheel) {
+            state->wheel_delta += event.delta;
+        }
+
+        events->push(event);
+    }
+
+    events->swap();
+
+    state->mouse_buttons = frame.mouse_buttons;
+    state->mouse_position = frame.mouse_position;
+    state->mouse_delta = frame.mouse_delta;
+}
+
+std::expected<void, std::string> replay_t::save() const
+{
+    std::ofstream stream(m_path, std::ios::binary);
+
+    replay_header_t header {
+        .version = VERSION,
+        .seed_count = static_cast<uint32_t>(m_seeds.size()),
+        .frame_count = static_cast<uint32_t>(m_frames.size()),
+        .event_count = static_cast<uint32_t>(m_events.size()),
+    };
+    std::memcpy(header.magic, REPLAY_MAGIC, sizeof(header.magic));
+
+    auto write = [&stream](const void* data, size_t size) {
+        stream.write(static_cast<const char*>(data), size);
+    };
+
+    write(&header, sizeof(header));
+    write(m_seeds.data(), m_seeds.size() * sizeof(uint64_t));
+    write(m_frames.data(), m_frames.size() * sizeof(replay_frame_t));
+    write(m_events.data(), m_events.size() * sizeof(input_event_t));
+
+    if (!stream.good()) {
+        return std::unexpected(
+            std::format("failed to write replay file '{}'", m_path.string()));
+    }
+
+    return {};
+}
+
+std::expected<void, std::string> replay_t::load()
+{
+    mapped_file_t file;
+    if (auto result = file.open(m_path); !result)
+        return result;
+
+    auto data = file.get_data();
+    size_t offset = 0;
+
+    auto read = [&data, &offset](void* out, size_t size) {
+        if (offset + size > data.size())
+            return false;
+
+        // `out` is null for an empty vector.
+        if (size > 0)
+            std::memcpy(out, data.data() + offset, size);
+
+        offset += size;
+        return true;
+    };
+
+    replay_header_t header;
+    if (!read(&header, sizeof(header))
+        || std::memcmp(header.magic, REPLAY_MAGIC, sizeof(header.magic))) {
+        return std::unexpected(
+            std::format("'{}' is not a replay file", m_path.string()));
+    }
+
+    if (header.version != VERSION) {
+        return std::unexpected(
+            std::format("'{}': unsupported replay version {}, expected {}",
+                        m_path.string(),
+                        header.version,
+                        VERSION));
+    }
+
+    // the counts are checked before anything is allocated for them.
+    auto seeds_size = size_t { header.seed_count } * sizeof(uint64_t);
+    auto frames_size = size_t { header.frame_count } * sizeof(replay_frame_t);
+    auto events_size = size_t { header.event_count } * sizeof(input_event_t);
+
+    if (seeds_size + frames_size + events_size > data.size() - offset) {
+        return std::unexpected(
+            std::format("'{}': replay file is truncated", m_path.string()));
+    }
+
+    m_seeds.resize(header.seed_count);
+    m_frames.resize(header.frame_count);
+    m_events.resize(header.event_count);
+
+    read(m_seeds.data(), seeds_size);
+    read(m_frames.data(), frames_size);
+    read(m_events.data(), events_size);
+
+    size_t frame_events = 0;
+    for (const auto& frame : m_frames)
+        frame_events += frame.event_count;
+
+    // the scancode is read as an integer, an out of range value isn't a
+    // valid `SDL_Scancode`.
+    bool valid = frame_events == m_events.size();
+    for (const auto& event : m_events) {
+        uint32_t scancode;
+        std::memcpy(&scancode, &event.scancode, sizeof(scancode));
+        valid = valid && scancode < SDL_SCANCODE_COUNT;
+    }
+
+    if (!valid) {
+        m_seeds.clear();
+        m_frames.clear();
+        m_events.clear();
+
+        return std::unexpected(
+            std::format("'{}': replay file is corrupted", m_path.string()));
+    }
+
+    m_next_seed = 0;
+    m_frame = SIZE_MAX;
+    m_event = 0;
+
+    return {};
+}
+
+replay_plugin_t::replay_plugin_t(replay_mode_t mode, fs::path path)
+    : m_mode(mode)
+    , m_path(std::move(path))
+{
+}
+
+PluginResult replay_plugin_t::build(app_t* app)
+{
+    auto rg = app->get_registry();
+
+    replay_t replay(m_mode, m_path);
+
+    if (m_mode == replay_mode_t::record) {
+        rg.put_resource<replay_t>(std::move(replay));
+
+        app->add_system(make_update<record>());
+        app->add_system(make_shutdown<shutdown>());
+
+        return {};
+    }
+
+    if (auto result = replay.load(); !result)
+        return result;
+
+    rg.put_resource<replay_t>(std::move(replay));
+    rg.put_resource<input_events_t>();
+    rg.put_resource<input_state_t>();
+
+    app->set_frame_clock([app]() {
+        return app->get_registry().get_resource<replay_t>().next_frame();
+    });
+
+    app->add_system(make_update<play>());
+
+    return {};
+}
+
+SystemResult replay_plugin_t::record(resource_t<replay_t> replay,
+                                     resource_t<const input_events_t> events,
+                                     resource_t<const input_state_t> state,
+                                     float dt)
+{
+    replay->record_frame(dt, events->get_events(), *state);
+    return {};
+}
+
+SystemResult replay_plugin_t::play(resource_t<const replay_t> replay,
+                                   resource_t<input_events_t> events,
+                                   resource_t<input_state_t> state)
+{
+    replay->apply_input(&*events, &*state);
+    return {};
+}
+
+SystemResult replay_plugin_t::shutdown(resource_t<const replay_t> replay)
+{
+    return replay->save();
+}
@@ -0,0 +1,367 @@
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <fstream>
+
+#include <snapshot.h>
+
+#include <mapped_file/mapped_file.h>
+
+// every section of the file starts on its own cache line.
+static constexpr size_t SECTION_ALIGNMENT = 64;
+
+static constexpr char SNAPSHOT_MAGIC[8] = {
+    'F', 'E', 'S', 'N', 'A', 'P', 0, 0
+};
+
+struct snapshot_header_t {
+    char magic[8];
+    uint32_t version;
+    uint32_t storage_count;
+    uint64_t entity_count;
+    uint64_t entities_in_use;
+};
+
+struct storage_header_t {
+    uint32_t id;
+    uint32_t element_size;
+    uint64_t count;
+};
+
+static size_t align_section(size_t offset)
+{
+    return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+class snapshot_writer_t {
+public:
+    snapshot_writer_t(const fs::path& path)
+        : m_stream(path, std::ios::binary | std::ios::trunc)
+    {
+    }
+
+    bool good() const
+    {
+        return m_stream.good();
+    }
+
+    void write(const void* data, size_t size)
+    {
+        m_stream.write(static_cast<const char*>(data), size);
+        m_offset += size;
+    }
+
+    void pad()
+    {
+        static constexpr char zeros[SECTION_ALIGNMENT] {};
+        write(zeros, align_section(m_offset) - m_offset);
+    }
+
+private:
+    std::ofstream m_stream;
+    size_t m_offset { 0 };
+};
+
+class snapshot_reader_t {
+public:
+    snapshot_reader_t(std::span<const std::byte> data)
+        : m_data(data)
+    {
+    }
+
+    const std::byte* read(size_t size)
+    {
+        if (size > m_data.size() - m_offset)
+            return nullptr;
+
+        auto data = m_data.data() + m_offset;
+        m_offset += size;
+
+        return data;
+    }
+
+    // `count` elements of `element_size` bytes, checked so a corrupted count
+    // can't wrap the size around.
+    const std::byte* read(uint64_t count, size_t element_size)
+    {
+        if (element_size && count > (m_data.size() - m_offset) / element_size)
+            return nullptr;
+
+        return read(count * element_size);
+    }
+
+    template<typename T>
+    bool read(T* value)
+    {
+        auto data = read(sizeof(T));
+        if (!data)
+            return false;
+
+        std::memcpy(value, data, sizeof(T));
+        return true;
+    }
+
+    void pad()
+    {
+        m_offset = std::min(align_section(m_offset), m_data.size());
+    }
+
+private:
+    std::span<const std::byte> m_data;
+    size_t m_offset { 0 };
+};
+
+std::expected<void, std::string>
+snapshot_schema_t::save(entt::registry* rg, const fs::path& path) const
+{
+    snapshot_writer_t writer(path);
+
+    if (!writer.good()) {
+        return std::unexpected(std::format(
+            "can't open snapshot file '{}' for writing", path.string()));
+    }
+
+    const auto& entities = rg->storage<entt::entity>();
+
+    snapshot_header_t header {
+        .version = VERSION,
+        .storage_count = static_cast<uint32_t>(m_components.size()),
+        .entity_count = entities.size(),
+        .entities_in_use = entities.free_list(),
+    };
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+
+    writer.write(&header, sizeof(header));
+    writer.pad();
+    writer.write(entities.data(), entities.size() * sizeof(entt::entity));
+
+    for (const auto& component : m_components) {
+        const auto& storage = component.storage(rg);
+
+        storage_header_t storage_header {
+            .id = component.id,
+            .element_size = component.element_size,
+            .count = storage.size(),
+        };
+
+        writer.pad();
+        writer.write(&storage_header, sizeof(storage_header));
+
+        writer.pad();
+        writer.write(storage.data(), storage.size() * sizeof(entt::entity));
+
+        if (!component.element_size)
+            continue;
+
+        writer.pad();
+        for (size_t offset = 0; offset < storage.size();
+             offset += component.page_size) {
+            auto count = std::min(component.page_size, storage.size() - offset);
+            writer.write(component.page(rg, offset / component.page_size),
+                         count * component.element_size);
+        }
+    }
+
+    if (!writer.good()) {
+        return std::unexpected(
+            std::format("failed to write snapshot file '{}'", path.string()));
+    }
+
+    return {};
+}
+
+std::expected<void, std::string>
+snapshot_schema_t::load(entt::registry* rg, const fs::path& path) const
+{
+    mapped_file_t file;
+    if (auto result = file.open(path); !result)
+        return result;
+
+    snapshot_reader_t reader(file.get_data());
+
+    snapshot_header_t header;
+    if (!reader.read(&header)
+        || std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic))) {
+        return std::unexpected(
+            std::format("'{}' is not a snapshot file", path.string()));
+    }
+
+    if (header.version != VERSION) {
+        return std::unexpected(
+            std::format("'{}': unsupported snapshot version {}, expected {}",
+                        path.string(),
+                        header.version,
+                        VERSION));
+    }
+
+    auto truncated = [&path]() {
+        return std::unexpected(
+            std::format("'{}': snapshot file is truncated", path.string()));
+    };
+
+    auto corrupted = [&path]() {
+        return std::unexpected(
+            std::format("'{}': snapshot file is corrupted", path.string()));
+    };
+
+    reader.pad();
+    auto entity_data = reader.read(header.entity_count, sizeof(entt::entity));
+    if (!entity_data)
+        return truncated();
+
+    if (header.entities_in_use > header.entity_count)
+        return corrupted();
+
+    std::vector<entt::entity> entities(header.entity_count);
+    std::memcpy(entities.data(),
+                entity_data,
+                entities.size() * sizeof(entt::entity));
+
+    // position + 1 of every entity in `entities` by its index, entity indices
+    // have to be unique.
+    std::vector<uint32_t> positions;
+    for (size_t i = 0; i < entities.size(); i++) {
+        auto index = entt::to_entity(entities[i]);
+        if (index == entt::entt_traits<entt::entity>::entity_mask)
+            return corrupted();
+
+        if (index >= positions.size())
+            positions.resize(index + 1);
+
+        if (positions[index])
+            return corrupted();
+
+        positions[index] = static_cast<uint32_t>(i + 1);
+    }
+
+    // the section that last held each entity index.
+    std::vector<uint32_t> section_of(positions.size());
+
+    struct section_t {
+        const component_t* component;
+        const std::byte* entities;
+        const std::byte* elements;
+        size_t count;
+    };
+
+    // validate the whole file before touching the registry, so a bad file
+    // leaves the world as it was.
+    std::vector<section_t> sections;
+    for (uint32_t i = 0; i < header.storage_count; i++) {
+        storage_header_t storage_header;
+
+        reader.pad();
+        if (!reader.read(&storage_header))
+            return truncated();
+
+        section_t section { .count = storage_header.count };
+
+        reader.pad();
+        section.entities
+            = reader.read(storage_header.count, sizeof(entt::entity));
+        if (!section.entities)
+            return truncated();
+
+        if (storage_header.element_size) {
+            reader.pad();
+            section.elements = reader.read(storage_header.count,
+                                           storage_header.element_size);
+            if (!section.elements)
+                return truncated();
+        }
+
+        // components only belong to live entities, each one once. the first
+        // `entities_in_use` entities are the live ones.
+        for (size_t j = 0; j < section.count; j++) {
+            entt::entity entity;
+            std::memcpy(&entity,
+                        section.entities + j * sizeof(entt::entity),
+                        sizeof(entt::entity));
+
+            auto index = entt::to_entity(entity);
+            if (index >= positions.size() || !positions[index]
+                || positions[index] > header.entities_in_use
+                || entities[positions[index] - 1] != entity
+                || section_of[index] == i + 1) {
+                return corrupted();
+            }
+
+            section_of[index] = i + 1;
+        }
+
+        for (const auto& component : m_components) {
+            if (component.id == storage_header.id)
+                section.component = &component;
+        }
+
+        // the component isn't registered anymore, skip its storage.
+        if (!section.component)
+            continue;
+
+        if (section.component->element_size != storage_header.element_size) {
+            return std::unexpected(std::format(
+                "'{}': component {} changed size from {} to {} bytes",
+                path.string(),
+                storage_header.id,
+                storage_header.element_size,
+                section.component->element_size));
+        }
+
+        sections.push_back(section);
+    }
+
+    rg->clear();
+
+    auto& storage = rg->storage<entt::entity>();
+    storage.clear();
+    storage.reserve(entities.size());
+
+    for (auto entity : entities)
+        storage.generate(entity);
+
+    storage.free_list(header.entities_in_use);
+
+    for (const auto& section : sections) {
+        const auto& component = *section.component;
+        auto element_size = component.element_size;
+
+        auto first = reinterpret_cast<const entt::entity*>(section.entities);
+        component.insert(rg, first, section.count);
+
+        if (!element_size)
+            continue;
+
+        auto& storage = component.storage(rg);
+
+        // owning groups may have reordered the storage while inserting, in
+        // which case the elements can't be copied page by page.
+        if (std::memcmp(storage.data(),
+                        section.entities,
+                        section.count * sizeof(entt::entity))
+            == 0) {
+            for (size_t offset = 0; offset < section.count;
+                 offset += component.page_size) {
+                auto count
+                    = std::min(component.page_size, section.count - offset);
+                std::memcpy(component.page(rg, offset / component.page_size),
+                            section.elements + offset * element_size,
+                            count * element_size);
+            }
+        } else {
+            for (size_t i = 0; i < section.count; i++) {
+                entt::entity entity;
+                std::memcpy(&entity,
+                            section.entities + i * sizeof(entt::entity),
+                            sizeof(entt::entity));
+
+                auto index = storage.index(entity);
+                auto page = component.page(rg, index / component.page_size);
+                std::memcpy(page + (index % component.page_size) * element_size,
+                            section.elements + i * element_size,
+                            element_size);
+            }
+        }
+    }
+
+    return {};
+}
@@ -0,0 +1,281 @@
+#include <algorithm>
+#include <utility>
+
+#include <task.h>
+
+static thread_local bool t_is_worker = false;
+
+void task_t::final_awaiter_t::await_suspend(handle_t handle) const noexcept
+{
+    handle.promise().scheduler->finish(handle);
+}
+
+task_t::task_t(handle_t handle)
+    : m_handle(handle)
+{
+}
+
+task_t::task_t(task_t&& other)
+    : m_handle(std::exchange(other.m_handle, {}))
+{
+}
+
+task_t::~task_t()
+{
+    if (m_handle)
+        m_handle.destroy();
+}
+
+task_wait_t::task_wait_t(task_wait_kind_t kind, task_condition_t condition)
+    : m_kind(kind)
+    , m_condition(std::move(condition))
+{
+}
+
+bool task_wait_t::await_ready() const
+{
+    if (m_kind == task_wait_kind_t::worker_thread)
+        return task_scheduler_t::is_worker_thread();
+
+    if (m_kind == task_wait_kind_t::main_thread)
+        return !task_scheduler_t::is_worker_thread();
+
+    return false;
+}
+
+void task_wait_t::await_suspend(task_t::handle_t handle)
+{
+    // another thread may resume the task as soon as it is queued, the
+    // awaiter lives in its frame and must not be touched afterwards.
+    handle.promise().scheduler->wait(handle, m_kind, std::move(m_condition));
+}
+
+task_wait_t next_frame()
+{
+    return { task_wait_kind_t::next_frame };
+}
+
+task_wait_t next_fixed_step()
+{
+    return { task_wait_kind_t::next_fixed_step };
+}
+
+task_wait_t worker_thread()
+{
+    return { task_wait_kind_t::worker_thread };
+}
+
+task_wait_t main_thread()
+{
+    return { task_wait_kind_t::main_thread };
+}
+
+task_wait_t wait_until(task_condition_t condition)
+{
+    return { task_wait_kind_t::condition, std::move(condition) };
+}
+
+task_scheduler_t::~task_scheduler_t()
+{
+    stop();
+}
+
+void task_scheduler_t::spawn(task_t task)
+{
+    auto handle = std::exchange(task.m_handle, {});
+    handle.promise().scheduler = this;
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_tasks.insert(handle.address());
+    }
+
+    handle.resume();
+}
+
+void task_scheduler_t::begin_frame()
+{
+    std::lock_guard lock(m_mutex);
+
+    m_frame_due.insert(
+        m_frame_due.end(), m_next_frame.begin(), m_next_frame.end());
+    m_next_frame.clear();
+}
+
+void task_scheduler_t::begin_fixed_step()
+{
+    std::lock_guard lock(m_mutex);
+
+    m_fixed_step_due.insert(m_fixed_step_due.end(),
+                            m_next_fixed_step.begin(),
+                            m_next_fixed_step.end());
+    m_next_fixed_step.clear();
+}
+
+TaskResult task_scheduler_t::resume_frame(registry_t rg)
+{
+    m_resuming.clear();
+    m_polling.clear();
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        std::swap(m_resuming, m_frame_due);
+        m_resuming.insert(
+            m_resuming.end(), m_main_thread.begin(), m_main_thread.end());
+        m_main_thread.clear();
+
+        std::swap(m_polling, m_waiting);
+    }
+
+    for (auto handle : m_resuming)
+        handle.resume();
+
+    for (auto& waiting : m_polling) {
+        if (waiting.condition(rg)) {
+            waiting.handle.resume();
+            continue;
+        }
+
+        std::lock_guard lock(m_mutex);
+        m_waiting.push_back(std::move(waiting));
+    }
+
+    return take_error();
+}
+
+TaskResult task_scheduler_t::resume_fixed_step()
+{
+    m_resuming.clear();
+
+    {
+        std::lock_guard lock(m_mutex);
+        std::swap(m_resuming, m_fixed_step_due);
+    }
+
+    for (auto handle : m_resuming)
+        handle.resume();
+
+    return take_error();
+}
+
+void task_scheduler_t::stop()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_wake.notify_all();
+
+    for (auto& worker : m_workers)
+        worker.join();
+
+    m_workers.clear();
+
+    for (auto address : m_tasks)
+        task_t::handle_t::from_address(address).destroy();
+
+    m_tasks.clear();
+    m_next_frame.clear();
+    m_next_fixed_step.clear();
+    m_frame_due.clear();
+    m_fixed_step_due.clear();
+    m_main_thread.clear();
+    m_waiting.clear();
+    m_worker_queue.clear();
+}
+
+size_t task_scheduler_t::get_task_count()
+{
+    std::lock_guard lock(m_mutex);
+    return m_tasks.size();
+}
+
+bool task_scheduler_t::is_worker_thread()
+{
+    return t_is_worker;
+}
+
+void task_scheduler_t::wait(task_t::handle_t handle,
+                            task_wait_kind_t kind,
+                            task_condition_t condition)
+{
+    std::unique_lock lock(m_mutex);
+
+    switch (kind) {
+    case task_wait_kind_t::next_frame:
+        m_next_frame.push_back(handle);
+        break;
+    case task_wait_kind_t::next_fixed_step:
+        m_next_fixed_step.push_back(handle);
+        break;
+    case task_wait_kind_t::main_thread:
+        m_main_thread.push_back(handle);
+        break;
+    case task_wait_kind_t::condition:
+        m_waiting.push_back({ std::move(condition), handle });
+        break;
+    case task_wait_kind_t::worker_thread:
+        if (m_workers.empty() && !m_stopping) {
+            auto count = std::max(2u, std::thread::hardware_concurrency()) - 1;
+            for (uint32_t i = 0; i < count; i++)
+                m_workers.emplace_back([this]() { run_worker(); });
+        }
+
+        m_worker_queue.push_back(handle);
+
+        lock.unlock();
+        m_wake.notify_one();
+        break;
+    }
+}
+
+void task_scheduler_t::finish(task_t::handle_t handle)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_tasks.erase(handle.address());
+
+        if (auto& result = handle.promise().result; !result)
+            m_errors.push_back(std::move(result.error()));
+    }
+
+    handle.destroy();
+}
+
+void task_scheduler_t::run_worker()
+{
+    t_is_worker = true;
+
+    while (true) {
+        task_t::handle_t handle;
+
+        {
+            std::unique_lock lock(m_mutex);
+            m_wake.wait(lock, [this]() {
+                return m_stopping || !m_worker_queue.empty();
+            });
+
+            if (m_stopping)
+                return;
+
+            handle = m_worker_queue.front();
+            m_worker_queue.pop_front();
+        }
+
+        handle.resume();
+    }
+}
+
+TaskResult task_scheduler_t::take_error()
+{
+    std::lock_guard lock(m_mutex);
+    if (m_errors.empty())
+        return {};
+
+    auto error = std::move(m_errors.front());
+    m_errors.clear();
+
+    return std::unexpected(std::move(error));
+}
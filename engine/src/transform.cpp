@@ -0,0 +1,224 @@
+#include <algorithm>
+
+#ifdef __SSE__
+    #include <xmmintrin.h>
+#endif
+
+#include <transform.h>
+
+static constexpr uint32_t UNKNOWN_DEPTH = UINT32_MAX;
+static constexpr uint32_t VISITING = UINT32_MAX - 1;
+
+static constexpr size_t PAGE_SIZE
+    = entt::component_traits<world_transform_t>::page_size;
+
+static_assert(entt::component_traits<transform_t>::page_size == PAGE_SIZE,
+              "transform storages must share their page size");
+
+// `out = a * b`, column major like glm.
+static void multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4* out)
+{
+#ifdef __SSE__
+    auto a0 = _mm_loadu_ps(&a[0][0]);
+    auto a1 = _mm_loadu_ps(&a[1][0]);
+    auto a2 = _mm_loadu_ps(&a[2][0]);
+    auto a3 = _mm_loadu_ps(&a[3][0]);
+
+    for (int32_t i = 0; i < 4; i++) {
+        auto column = _mm_mul_ps(a0, _mm_set1_ps(b[i][0]));
+        column = _mm_add_ps(column, _mm_mul_ps(a1, _mm_set1_ps(b[i][1])));
+        column = _mm_add_ps(column, _mm_mul_ps(a2, _mm_set1_ps(b[i][2])));
+        column = _mm_add_ps(column, _mm_mul_ps(a3, _mm_set1_ps(b[i][3])));
+
+        _mm_storeu_ps(&(*out)[i][0], column);
+    }
+#else
+    *out = a * b;
+#endif
+}
+
+static glm::mat4 compose(const transform_t& transform)
+{
+    auto matrix = glm::mat4_cast(transform.rotation);
+
+    matrix[0] *= transform.scale.x;
+    matrix[1] *= transform.scale.y;
+    matrix[2] *= transform.scale.z;
+    matrix[3] = glm::vec4(transform.position, 1.0f);
+
+    return matrix;
+}
+
+static void on_structure_changed(entt::registry& rg, entt::entity)
+{
+    rg.ctx().get<transform_hierarchy_t>().structure_dirty = true;
+}
+
+static void on_transform_constructed(entt::registry& rg, entt::entity entity)
+{
+    rg.emplace_or_replace<world_transform_t>(entity);
+    on_structure_changed(rg, entity);
+}
+
+static void on_transform_updated(entt::registry& rg, entt::entity entity)
+{
+    auto& hierarchy = rg.ctx().get<transform_hierarchy_t>();
+    if (hierarchy.structure_dirty)
+        return;
+
+    hierarchy.dirty[rg.storage<world_transform_t>().index(entity)] = 1;
+}
+
+static void on_transform_destroyed(entt::registry& rg, entt::entity entity)
+{
+    rg.remove<world_transform_t>(entity);
+    on_structure_changed(rg, entity);
+}
+
+// sorts both transform storages by depth and records the parent of every
+// node. entities whose parent has no transform, or that are part of a cycle,
+// become roots. nodes are the entities with a `transform_t`, a
+// `world_transform_t` without one is left alone at the end of its storage.
+static void rebuild(entt::registry* rg, transform_hierarchy_t* hierarchy)
+{
+    auto& locals = rg->storage<transform_t>();
+    auto& worlds = rg->storage<world_transform_t>();
+    auto& depths = hierarchy->depths;
+
+    const entt::sparse_set& nodes = worlds;
+    const entt::sparse_set& local_nodes = locals;
+
+    // a node whose world transform was removed gets it back, so index `i`
+    // of both storages is the same node.
+    for (auto entity : local_nodes) {
+        if (!worlds.contains(entity))
+            rg->emplace<world_transform_t>(entity);
+    }
+
+    depths.assign(rg->storage<entt::entity>().size(), UNKNOWN_DEPTH);
+
+    auto get_parent = [rg, &locals](entt::entity entity) {
+        auto parent = rg->try_get<parent_t>(entity);
+        if (!parent || !locals.contains(parent->entity))
+            return entt::entity { entt::null };
+
+        return parent->entity;
+    };
+
+    auto depth = [&depths](entt::entity entity) -> uint32_t& {
+        return depths[entt::to_entity(entity)];
+    };
+
+    std::vector<entt::entity> chain;
+
+    for (auto entity : local_nodes) {
+        chain.clear();
+
+        uint32_t base = 0;
+        for (auto node = entity; node != entt::null; node = get_parent(node)) {
+            if (depth(node) == VISITING)
+                break;
+
+            if (depth(node) != UNKNOWN_DEPTH) {
+                base = depth(node) + 1;
+                break;
+            }
+
+            depth(node) = VISITING;
+            chain.push_back(node);
+        }
+
+        for (auto it = chain.rbegin(); it != chain.rend(); it++)
+            depth(*it) = base++;
+    }
+
+    // storages are sorted back to front, this leaves the shallowest nodes at
+    // the start of the packed arrays. entities that aren't nodes keep an
+    // unknown depth and end up behind every node.
+    worlds.sort([&depth](entt::entity lhs, entt::entity rhs) {
+        return depth(lhs) > depth(rhs);
+    });
+    locals.sort_as(nodes.begin(), nodes.end());
+
+    auto count = locals.size();
+    hierarchy->parents.resize(count);
+    hierarchy->dirty.assign(count, 1);
+
+    for (size_t i = 0; i < count; i++) {
+        auto entity = nodes.data()[i];
+        auto parent = get_parent(entity);
+
+        hierarchy->parents[i]
+            = parent != entt::null && depth(parent) < depth(entity)
+            ? static_cast<uint32_t>(worlds.index(parent))
+            : transform_hierarchy_t::NO_PARENT;
+    }
+
+    hierarchy->structure_dirty = false;
+}
+
+PluginResult transform_plugin_t::build(app_t* app)
+{
+    auto rg = app->get_registry();
+    rg.put_resource<transform_hierarchy_t>();
+
+    auto native = rg.get_native();
+    native->on_construct<transform_t>().connect<&on_transform_constructed>();
+    native->on_update<transform_t>().connect<&on_transform_updated>();
+    native->on_destroy<transform_t>().connect<&on_transform_destroyed>();
+
+    // the world transform storage has to hold exactly the nodes, any other
+    // change to it is a structure change too.
+    native->on_construct<world_transform_t>().connect<&on_structure_changed>();
+    native->on_destroy<world_transform_t>().connect<&on_structure_changed>();
+
+    native->on_construct<parent_t>().connect<&on_structure_changed>();
+    native->on_update<parent_t>().connect<&on_structure_changed>();
+    native->on_destroy<parent_t>().connect<&on_structure_changed>();
+
+    app->add_system(make_update<update>());
+
+    return {};
+}
+
+SystemResult transform_plugin_t::update(registry_t rg)
+{
+    auto native = rg.get_native();
+    auto& hierarchy = rg.get_resource<transform_hierarchy_t>();
+
+    if (hierarchy.structure_dirty)
+        rebuild(native, &hierarchy);
+
+    auto locals = native->storage<transform_t>().raw();
+    auto worlds = native->storage<world_transform_t>().raw();
+
+    const auto& parents = hierarchy.parents;
+    auto& dirty = hierarchy.dirty;
+
+    // parents come first, so one pass in storage order sees every parent
+    // before its children.
+    for (size_t i = 0; i < parents.size(); i++) {
+        auto parent = parents[i];
+        if (parent != transform_hierarchy_t::NO_PARENT)
+            dirty[i] |= dirty[parent];
+
+        if (!dirty[i])
+            continue;
+
+        auto local = compose(locals[i / PAGE_SIZE][i % PAGE_SIZE]);
+        auto& world = worlds[i / PAGE_SIZE][i % PAGE_SIZE].matrix;
+
+        if (parent == transform_hierarchy_t::NO_PARENT) {
+            world = local;
+        } else {
+            multiply(
+                worlds[parent / PAGE_SIZE][parent % PAGE_SIZE].matrix,
+                local,
+                &world);
+        }
+    }
+
+    std::fill(dirty.begin(), dirty.end(), 0);
+
+    return {};
+}
@@ -1,21 +1,94 @@
+#include <optional>
+
 #include <fecs.h>
 #include <window_sdl.h>
 
+// copies the keyboard and mouse state sdl has after its last pump, the
+// relative motion is added to `mouse_delta`.
+static void sample_devices(input_state_t* state, glm::vec2* mouse_delta)
+{
+    int32_t key_count = 0;
+    auto keys = SDL_GetKeyboardState(&key_count);
+
+    for (int32_t i = 0; i < key_count && i < SDL_SCANCODE_COUNT; i++)
+        state->keys_down[i] = keys[i];
+
+    state->mouse_buttons = SDL_GetMouseState(&state->mouse_position.x,
+                                             &state->mouse_position.y);
+
+    glm::vec2 delta;
+    SDL_GetRelativeMouseState(&delta.x, &delta.y);
+    *mouse_delta += delta;
+}
+
+static std::optional<input_event_t> translate_event(const SDL_Event& event)
+{
+    input_event_t result { .timestamp_ns = event.common.timestamp };
+
+    switch (event.type) {
+    case SDL_EVENT_QUIT:
+        result.type = input_event_type_t::quit;
+        break;
+    case SDL_EVENT_KEY_DOWN:
+    case SDL_EVENT_KEY_UP:
+        result.type = event.key.down ? input_event_type_t::key_down
+                                     : input_event_type_t::key_up;
+        result.key = event.key.key;
+        result.scancode = event.key.scancode;
+        result.repeat = event.key.repeat;
+        break;
+    case SDL_EVENT_MOUSE_MOTION:
+        result.type = input_event_type_t::mouse_motion;
+        result.position = glm::vec2(event.motion.x, event.motion.y);
+        result.delta = glm::vec2(event.motion.xrel, event.motion.yrel);
+        break;
+    case SDL_EVENT_MOUSE_BUTTON_DOWN:
+    case SDL_EVENT_MOUSE_BUTTON_UP:
+        result.type = event.button.down ? input_event_type_t::mouse_button_down
+                                        : input_event_type_t::mouse_button_up;
+        result.button = event.button.button;
+        result.position = glm::vec2(event.button.x, event.button.y);
+        break;
+    case SDL_EVENT_MOUSE_WHEEL:
+        result.type = input_event_type_t::mouse_wheel;
+        result.position = glm::vec2(event.wheel.mouse_x, event.wheel.mouse_y);
+        result.delta = glm::vec2(event.wheel.x, event.wheel.y);
+        break;
+    // the size in pixels, which is what the viewport needs. it differs from
+    // the window size on high density displays.
+    case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+        result.type = input_event_type_t::window_resized;
+        result.size = glm::ivec2(event.window.data1, event.window.data2);
+        break;
+    default:
+        return {};
+    }
+
+    return result;
+}
+
 window_sdl_t::window_sdl_t(const char* title,
                            int32_t width,
                            int32_t height,
-                           UpdateSystem event_handler)
+                           bool late_input_sampling)
 {
     m_info.title = title;
     m_info.width = width;
     m_info.height = height;
 
-    m_event_handler = std::move(event_handler);
+    m_late_input_sampling = late_input_sampling;
+}
+
+window_sdl_t::window_sdl_t(window_creation_info_t info,
+                           bool late_input_sampling)
+    : m_info(info)
+    , m_late_input_sampling(late_input_sampling)
+{
 }
 
 window_sdl_t::window_sdl_t(window_sdl_t&& other)
     : m_info(other.m_info)
-    , m_event_handler(std::move(other.m_event_handler))
+    , m_late_input_sampling(other.m_late_input_sampling)
 {
 }
 
@@ -23,14 +96,22 @@ PluginResult window_sdl_t::build(app_t* app)
 {
     auto rg = app->get_registry();
     rg.put_resource<window_creation_info_t>(m_info);
+    rg.put_resource<input_events_t>();
+    rg.put_resource<input_state_t>();
 
     app->add_system(make_startup(setup));
-    app->add_system(make_update(m_event_handler));
+    app->add_system(make_update<pump_events>());
     app->add_system(make_shutdown(shutdown));
 
     return {};
 }
 
+void window_sdl_t::add_late_input_sampling(app_t* app) const
+{
+    if (m_late_input_sampling && !m_info.external_input)
+        app->add_system(make_update<sample_input>());
+}
+
 window_creation_info_t window_sdl_t::get_creation_info() const
 {
     return m_info;
@@ -38,6 +119,11 @@ window_creation_info_t window_sdl_t::get_creation_info() const
 
 SystemResult window_sdl_t::setup(registry_t rg)
 {
+    auto info = rg.get_resource<window_creation_info_t>();
+
+    if (info.headless)
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+
     if (!SDL_Init(SDL_INIT_VIDEO)) {
         return std::unexpected(
             std::format("cannot initialize sdl: {}", SDL_GetError()));
@@ -49,20 +135,17 @@ SystemResult window_sdl_t::setup(registry_t rg)
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK,
                         SDL_GL_CONTEXT_PROFILE_CORE);
 
-    SDL_Window* window;
-
-    {
-        auto& info = rg.get_resource<window_creation_info_t>();
+    SDL_WindowFlags flags = SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE;
+    if (info.headless)
+        flags |= SDL_WINDOW_HIDDEN;
 
-        window = SDL_CreateWindow(
-            info.title, info.width, info.height, SDL_WINDOW_OPENGL);
-        if (!window) {
-            auto result = std::unexpected(
-                std::format("cannot create sdl window: {}", SDL_GetError()));
+    auto window = SDL_CreateWindow(info.title, info.width, info.height, flags);
+    if (!window) {
+        auto result = std::unexpected(
+            std::format("cannot create sdl window: {}", SDL_GetError()));
 
-            SDL_Quit();
-            return result;
-        }
+        SDL_Quit();
+        return result;
     }
 
     SDL_GLContext context = SDL_GL_CreateContext(window);
@@ -92,6 +175,57 @@ SystemResult window_sdl_t::setup(registry_t rg)
     return {};
 }
 
+SystemResult
+window_sdl_t::pump_events(resource_t<const window_creation_info_t> info,
+                          resource_t<input_events_t> events,
+                          resource_t<input_state_t> state)
+{
+    if (info->external_input) {
+        SDL_PumpEvents();
+        SDL_FlushEvents(SDL_EVENT_FIRST, SDL_EVENT_LAST);
+        return {};
+    }
+
+    state->keys_pressed.fill(0);
+    state->keys_released.fill(0);
+    state->mouse_delta = state->late_mouse_delta;
+    state->late_mouse_delta = glm::vec2(0.0f);
+    state->wheel_delta = glm::vec2(0.0f);
+
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+        auto translated = translate_event(event);
+        if (!translated)
+            continue;
+
+        if (translated->type == input_event_type_t::key_down)
+            state->keys_pressed[translated->scancode] = 1;
+        else if (translated->type == input_event_type_t::key_up)
+            state->keys_released[translated->scancode] = 1;
+        else if (translated->type == input_event_type_t::mouse_wheel)
+            state->wheel_delta += translated->delta;
+
+        events->push(*translated);
+    }
+
+    events->swap();
+    sample_devices(&*state, &state->mouse_delta);
+
+    return {};
+}
+
+// leaves the events queued for the next frame, only the device state is
+// refreshed. systems may have read `mouse_delta` already, so the motion is
+// kept in `late_mouse_delta`. a renderer applies it to the view, or else it
+// is added to the next frame's delta.
+SystemResult window_sdl_t::sample_input(resource_t<input_state_t> state)
+{
+    SDL_PumpEvents();
+    sample_devices(&*state, &state->late_mouse_delta);
+
+    return {};
+}
+
 SystemResult window_sdl_t::shutdown(registry_t rg)
 {
     auto& sdl_context = rg.get_resource<sdl_context_t>();
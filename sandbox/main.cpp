@@ -1,29 +1,34 @@
 #include <app.h>
+#include <physics_2d.h>
 #include <renderer_2d.h>
+#include <replay.h>
+#include <resource_pack.h>
 
+#include <format>
+#include <fstream>
+#include <optional>
+#include <print>
 #include <random>
+#include <string_view>
+#include <vector>
 
-struct velocity_t {
-    float x;
-    float y;
-};
+static constexpr const char* WINDOW_TITLE = "Basic 2D Renderer (OpenGL)";
+static constexpr int32_t WINDOW_WIDTH = 1280;
+static constexpr int32_t WINDOW_HEIGHT = 720;
 
-static velocity_t make_velocity(glm::vec2 direction)
-{
-    return { .x = direction.x, .y = direction.y };
-}
+static constexpr uint32_t BODY_COUNT = 2000;
 
-static SystemResult sdl_event_handler(registry_t rg, float)
+static SystemResult handle_input(resource_t<const input_events_t> events,
+                                 resource_t<app_state_t*> app_state)
 {
-    auto app_state = rg.get_resource<app_state_t*>();
-
-    SDL_Event event;
-    while (SDL_PollEvent(&event)) {
-        if (event.type == SDL_EVENT_QUIT)
-            app_state->running = false;
+    for (const auto& event : events->get_events()) {
+        if (event.type == input_event_type_t::quit)
+            (*app_state)->running = false;
 
-        if (event.type == SDL_EVENT_KEY_DOWN && event.key.key == SDLK_ESCAPE)
-            app_state->running = false;
+        if (event.type == input_event_type_t::key_down
+            && event.key == SDLK_ESCAPE) {
+            (*app_state)->running = false;
+        }
     }
 
     return {};
@@ -31,69 +36,143 @@ static SystemResult sdl_event_handler(registry_t rg, float)
 
 static SystemResult setup(registry_t rg)
 {
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    // seeds come from the replay so a replayed session spawns the same bodies
+    uint64_t seed = 0;
+    if (auto replay = rg.try_get_resource<replay_t>())
+        seed = replay->make_seed();
+    else
+        seed = std::random_device()();
+
+    std::mt19937 gen(static_cast<std::mt19937::result_type>(seed));
     std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
 
     auto info = rg.get_resource<window_creation_info_t>();
 
-    auto dimension = glm::vec2(20.0f);
-    auto position = glm::vec2(info.width / 2.0f - dimension.x / 2.0f,
-                              info.height / 2.0f - dimension.y / 2.0f);
+    auto dimension = glm::vec2(8.0f);
+    auto center = glm::vec2(info.width, info.height) / 2.0f;
+
+    float coefficient = 200.0f;
+
+    for (uint32_t i = 0; i < BODY_COUNT; i++) {
+        auto offset = glm::vec2(dist(gen), dist(gen)) * center * 0.9f;
+        auto velocity = glm::vec2(dist(gen), dist(gen)) * coefficient;
 
-    float coefficient = 1000.0f;
-    float x = std::min(dist(gen), 0.1f);
-    float y = std::min(dist(gen), 0.1f);
+        rg.spawn_entity(
+            make_quad(center + offset - dimension / 2.0f, dimension),
+            rigid_body_2d_t {
+                .velocity = velocity,
+                .shape = i % 2 ? collider_shape_2d_t::circle
+                               : collider_shape_2d_t::aabb,
+            });
+    }
 
-    rg.spawn_entity(make_quad(position, dimension),
-                    make_velocity(glm::vec2(x * coefficient, y * coefficient)));
     return {};
 }
 
-static SystemResult update(registry_t rg, float dt)
+// writes a captured frame as a binary ppm with its rows top down.
+static void write_frame(const fs::path& directory, captured_frame_t frame)
 {
-    auto info = rg.get_resource<window_creation_info_t>();
-
-    float window_width = static_cast<float>(info.width);
-    float window_height = static_cast<float>(info.height);
+    auto path = directory / std::format("frame_{:06}.ppm", frame.frame);
 
-    auto view = rg.get_view<quad_2d_t, velocity_t>();
-    for (auto entity : view) {
-        auto [quad, velocity] = view.get(entity);
+    std::ofstream stream(path, std::ios::binary);
+    stream << std::format("P6\n{} {}\n255\n", frame.width, frame.height);
 
-        quad.position.x += velocity.x * dt;
-        quad.position.y += velocity.y * dt;
+    std::vector<uint8_t> row(frame.width * 3);
+    for (int32_t y = frame.height - 1; y >= 0; y--) {
+        auto pixels = frame.pixels.data() + size_t(y) * frame.width * 4;
 
-        if (quad.position.x + quad.dimension.x >= window_width) {
-            quad.position.x = window_width - quad.dimension.x;
-            velocity.x *= -1;
-        } else if (quad.position.x <= 0.0f) {
-            quad.position.x = 0.0f;
-            velocity.x *= -1;
+        for (int32_t x = 0; x < frame.width; x++) {
+            row[x * 3 + 0] = pixels[x * 4 + 0];
+            row[x * 3 + 1] = pixels[x * 4 + 1];
+            row[x * 3 + 2] = pixels[x * 4 + 2];
         }
 
-        if (quad.position.y + quad.dimension.y >= window_height) {
-            quad.position.y = window_height - quad.dimension.y;
-            velocity.y *= -1;
-        } else if (quad.position.y <= 0.0f) {
-            quad.position.y = 0.0f;
-            velocity.y *= -1;
-        }
+        stream.write(reinterpret_cast<const char*>(row.data()), row.size());
     }
-
-    return {};
 }
 
-int32_t main()
+int32_t main(int32_t argc, char** argv)
 {
+    // --record <path> captures the session and --replay <path> plays it
+    // back without a window. --capture <directory> writes every frame as an
+    // image, without a display with --headless or --replay. --pack <path>
+    // reads the resources from a pack built by the pack tool.
+    std::optional<replay_mode_t> mode;
+    fs::path replay_path;
+    fs::path capture_path;
+    bool headless = false;
+
+    for (int32_t i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--headless") {
+            headless = true;
+            continue;
+        }
+
+        if (i + 1 == argc)
+            break;
+
+        if (arg == "--record") {
+            mode = replay_mode_t::record;
+            replay_path = argv[++i];
+        } else if (arg == "--replay") {
+            mode = replay_mode_t::replay;
+            replay_path = argv[++i];
+        } else if (arg == "--capture") {
+            capture_path = argv[++i];
+        } else if (arg == "--pack") {
+            if (auto result = mount_resource_pack(argv[++i]); !result) {
+                std::println(stderr, "ERROR: {}", result.error());
+                return 1;
+            }
+        }
+    }
+
     app_t app;
-    app.add_plugin(make_plugin<renderer_2d_t>(window_sdl_t(
-        "Basic 2D Renderer (OpenGL)", 1280, 720, sdl_event_handler)));
+
+    bool replaying = mode == replay_mode_t::replay;
+    bool capturing = !capture_path.empty();
+
+    if (replaying && !capturing) {
+        app.add_plugin(
+            make_plugin<replay_plugin_t>(replay_mode_t::replay, replay_path));
+        app.get_registry().put_resource<window_creation_info_t>(
+            window_creation_info_t {
+                WINDOW_TITLE, WINDOW_WIDTH, WINDOW_HEIGHT });
+    } else {
+        frame_capture_settings_t capture;
+        if (capturing) {
+            std::error_code error;
+            fs::create_directories(capture_path, error);
+
+            capture.on_frame = [capture_path](captured_frame_t frame) {
+                write_frame(capture_path, std::move(frame));
+            };
+        }
+
+        app.add_plugin(make_plugin<renderer_2d_t>(
+            window_sdl_t(window_creation_info_t {
+                .title = WINDOW_TITLE,
+                .width = WINDOW_WIDTH,
+                .height = WINDOW_HEIGHT,
+                .headless = headless || replaying,
+                .external_input = replaying,
+            }),
+            std::move(capture)));
+    }
+
+    if (mode == replay_mode_t::record || (replaying && capturing))
+        app.add_plugin(make_plugin<replay_plugin_t>(*mode, replay_path));
+
+    app.add_plugin(make_plugin<physics_2d_t>(physics_2d_settings_t {
+        .use_bounds = true,
+        .bounds_max = glm::vec2(WINDOW_WIDTH, WINDOW_HEIGHT),
+    }));
 
     app.add_system(make_startup(setup));
-    app.add_system(make_update(update));
+    app.add_system(make_update<handle_input>());
 
     app.run();
 
     return 0;
-}
\ No newline at end of file
+}
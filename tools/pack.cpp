@@ -0,0 +1,93 @@
+// bundles a directory into a resource pack for `mount_resource_pack`:
+//
+//     pack resources resources.pack [--compress]
+//
+// run it from the directory the app runs in so the names in the pack match
+// the paths the loaders ask for. images are cooked first and only the cooked
+// textures are packed.
+#include <pack/pack.h>
+#include <texture/texture.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <print>
+#include <string_view>
+#include <vector>
+
+static constexpr std::array<std::string_view, 5> IMAGE_EXTENSIONS = {
+    ".png", ".jpg", ".jpeg", ".tga", ".bmp"
+};
+
+int32_t main(int32_t argc, char** argv)
+{
+    if (argc < 3) {
+        std::println(stderr,
+                     "usage: {} <directory> <output> [--compress]",
+                     argv[0]);
+        return 1;
+    }
+
+    fs::path directory = argv[1];
+    fs::path output = argv[2];
+    bool compress = argc > 3 && std::string_view(argv[3]) == "--compress";
+
+    std::vector<fs::path> paths;
+
+    std::error_code error;
+    fs::recursive_directory_iterator it(directory, error);
+    for (const auto& entry : it) {
+        if (entry.is_regular_file())
+            paths.push_back(entry.path());
+    }
+
+    if (error) {
+        std::println(stderr,
+                     "ERROR: can't read directory '{}': {}",
+                     directory.string(),
+                     error.message());
+        return 1;
+    }
+
+    std::ranges::sort(paths);
+
+    std::vector<pack_source_t> sources;
+    uint64_t total_size = 0;
+
+    for (const auto& path : paths) {
+        auto extension = path.extension().string();
+        std::ranges::transform(extension, extension.begin(), ::tolower);
+
+        // cooked next to their images, packed when the image is.
+        if (extension == ".ftex")
+            continue;
+
+        auto source = path;
+
+        if (std::ranges::find(IMAGE_EXTENSIONS, extension)
+            != IMAGE_EXTENSIONS.end()) {
+            auto cooked = cook_texture_cached(path);
+            if (!cooked) {
+                std::println(stderr, "ERROR: {}", cooked.error());
+                return 1;
+            }
+
+            source = *cooked;
+        }
+
+        total_size += fs::file_size(source, error);
+        sources.push_back({ make_pack_name(source), source });
+    }
+
+    if (auto result = write_pack(sources, output, compress); !result) {
+        std::println(stderr, "ERROR: {}", result.error());
+        return 1;
+    }
+
+    std::println("packed {} files, {} bytes into {} bytes",
+                 sources.size(),
+                 total_size,
+                 fs::file_size(output, error));
+
+    return 0;
+}